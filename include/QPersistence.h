@@ -1,3 +1,4 @@
+#include "../src/cursor.h"
 #include "../src/dataaccessobject.h"
 #include "../src/databaseschema.h"
 #include "../src/defaultstorage.h"
@@ -10,6 +11,7 @@
 #include "../src/relations.h"
 #include "../src/reply.h"
 #include "../src/schemaversioning.h"
+#include "../src/session.h"
 #include "../src/sortfilterproxyobjectmodel.h"
 #include "../src/sqlquery.h"
 #include "../src/storage.h"
@@ -0,0 +1 @@
+#include "../../src/cursor.h"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "../../src/session.h"
\ No newline at end of file
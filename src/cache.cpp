@@ -1,32 +1,495 @@
 #include "cache.h"
 
+#include "metaproperty.h"
 #include "private.h"
 
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QHash>
 #include <QSharedData>
-#include <QLinkedList>
+#include <QStringList>
+#ifndef QP_NO_GUI
+#include <QImage>
+#include <QPixmap>
+#endif
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 
+// Rough size of a QObject with its private data and the dynamic properties QPersistence attaches to it
+static const qint64 OBJECT_OVERHEAD = 256;
+
+
+/******************************************************************************
+ * QpCacheSizeEstimator
+ */
+QpCacheSizeEstimator::~QpCacheSizeEstimator()
+{
+}
+
+
+/******************************************************************************
+ * QpDefaultCacheSizeEstimator
+ */
+QpDefaultCacheSizeEstimator::QpDefaultCacheSizeEstimator(const QpMetaObject &metaObject) :
+    QpCacheSizeEstimator(),
+    m_metaObject(metaObject)
+{
+}
+
+QpDefaultCacheSizeEstimator::~QpDefaultCacheSizeEstimator()
+{
+}
+
+qint64 QpDefaultCacheSizeEstimator::estimateSize(const QObject *object) const
+{
+    qint64 size = OBJECT_OVERHEAD;
+    foreach (const QpMetaProperty property, m_metaObject.simpleProperties()) {
+        size += estimateSize(property.metaProperty().read(object));
+    }
+    return size;
+}
+
+qint64 QpDefaultCacheSizeEstimator::estimateSize(const QVariant &value)
+{
+    qint64 size = sizeof(QVariant);
+
+    switch (value.userType()) {
+    case QMetaType::QString:
+        return size + value.toString().size() * sizeof(QChar);
+    case QMetaType::QByteArray:
+        return size + value.toByteArray().size();
+    case QMetaType::QStringList:
+        foreach (const QString &string, value.toStringList()) {
+            size += sizeof(QString) + string.size() * sizeof(QChar);
+        }
+        return size;
+#ifndef QP_NO_GUI
+    case QMetaType::QPixmap: {
+        QPixmap pixmap = value.value<QPixmap>();
+        return size + qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    }
+    case QMetaType::QImage: {
+        QImage image = value.value<QImage>();
+        return size + qint64(image.bytesPerLine()) * image.height();
+    }
+#endif
+    default:
+        break;
+    }
+
+    // Values, which are stored inline in the QVariant, have a size of 0 here
+    int typeSize = QMetaType::sizeOf(value.userType());
+    if (typeSize > static_cast<int>(sizeof(QVariant)))
+        size += typeSize;
+
+    return size;
+}
+
+
+/******************************************************************************
+ * QpCacheStatistics
+ */
+QpCacheStatistics::QpCacheStatistics() :
+    hits(0),
+    resurrections(0),
+    misses(0),
+    evictions(0),
+    inserts(0),
+    removes(0)
+{
+}
+
+double QpCacheStatistics::hitRatio() const
+{
+    quint64 lookups = hits + resurrections + misses;
+    if (lookups == 0)
+        return 0.0;
+
+    return double(hits + resurrections) / lookups;
+}
+
+QpCacheStatistics &QpCacheStatistics::operator+=(const QpCacheStatistics &rhs)
+{
+    hits += rhs.hits;
+    resurrections += rhs.resurrections;
+    misses += rhs.misses;
+    evictions += rhs.evictions;
+    inserts += rhs.inserts;
+    removes += rhs.removes;
+    return *this;
+}
+
 
 /******************************************************************************
  * QpCacheData
  */
+class QpCacheMemoryPoolData;
 class QpCacheData : public QSharedData {
 public:
+    struct Node;
+
+    // An intrusive LRU list. The list is ordered from the least recently used
+    // object (head) to the most recently used object (tail).
+    struct Segment {
+        Segment() : head(nullptr), tail(nullptr), size(0) {}
+        Node *head;
+        Node *tail;
+        int size;
+    };
+
+    struct Node {
+        int id;
+        QSharedPointer<QObject> object;
+        qint64 cost;
+        quint64 tick;
+        Segment *segment;
+        Node *previous;
+        Node *next;
+    };
+
+    QpCacheData();
+    ~QpCacheData();
+
     int strongCacheSize;
+    qint64 maximumCost;
+    qint64 cost;
+    QpCache::AdmissionPolicy admissionPolicy;
     QHash<int, QWeakPointer<QObject> > weakCacheById;
-    mutable QLinkedList<QSharedPointer<QObject> > strongCache;
+    QHash<int, Node *> strongCacheById;
+    // With the Probation policy, new objects enter the probation segment and
+    // are only promoted to the main segment when they are accessed again.
+    // Objects are always evicted from the probation segment first.
+    Segment mainSegment;
+    Segment probationSegment;
+    QSharedPointer<QpCacheSizeEstimator> sizeEstimator;
+    QExplicitlySharedDataPointer<QpCacheMemoryPoolData> pool;
+
+    // Counters are atomic, so that they can be polled from other threads
+    QAtomicInteger<quint64> hits;
+    QAtomicInteger<quint64> resurrections;
+    QAtomicInteger<quint64> misses;
+    QAtomicInteger<quint64> evictions;
+    QAtomicInteger<quint64> inserts;
+    QAtomicInteger<quint64> removes;
+
+    void touch(int id, QSharedPointer<QObject> object);
+    void removeFromStrongCache(int id);
+    Node *nextVictim() const;
+    void evictLeastRecentlyUsed();
+    void trim();
+
+    bool isCostTracked() const;
+    void recalculateCosts();
+    void setPool(QpCacheMemoryPoolData *newPool);
+
+private:
+    qint64 estimateSize(const QObject *object) const;
+    int maximumMainSegmentSize() const;
+    void unlink(Node *node);
+    void append(Segment *segment, Node *node);
+    void removeNode(Node *node);
+};
+
 
-    void adjustQueue(QSharedPointer<QObject> accessedObject) const;
+/******************************************************************************
+ * QpCacheMemoryPoolData
+ */
+class QpCacheMemoryPoolData : public QSharedData {
+public:
+    QpCacheMemoryPoolData() :
+        QSharedData(),
+        maximumCost(-1),
+        cost(0),
+        clock(0)
+    {}
+
+    qint64 maximumCost;
+    qint64 cost;
+    quint64 clock;
+    QList<QpCacheData *> caches;
+
+    void trim();
 };
 
-void QpCacheData::adjustQueue(QSharedPointer<QObject> accessedObject) const
+void QpCacheMemoryPoolData::trim()
+{
+    if (maximumCost < 0)
+        return;
+
+    while (maximumCost < cost) {
+        // Evict the object, which has been used least recently in any of the caches
+        QpCacheData *oldest = nullptr;
+        QpCacheData::Node *oldestVictim = nullptr;
+        foreach (QpCacheData *cache, caches) {
+            QpCacheData::Node *victim = cache->nextVictim();
+            if (victim && (!oldestVictim || victim->tick < oldestVictim->tick)) {
+                oldest = cache;
+                oldestVictim = victim;
+            }
+        }
+
+        if (!oldest)
+            return;
+
+        oldest->evictLeastRecentlyUsed();
+    }
+}
+
+
+/******************************************************************************
+ * QpCacheData
+ */
+QpCacheData::QpCacheData() :
+    QSharedData(),
+    strongCacheSize(50),
+    maximumCost(-1),
+    cost(0),
+    admissionPolicy(QpCache::AdmitAll),
+    hits(0),
+    resurrections(0),
+    misses(0),
+    evictions(0),
+    inserts(0),
+    removes(0)
+{
+}
+
+QpCacheData::~QpCacheData()
+{
+    setPool(nullptr);
+    qDeleteAll(strongCacheById);
+}
+
+qint64 QpCacheData::estimateSize(const QObject *object) const
+{
+    if (sizeEstimator)
+        return sizeEstimator->estimateSize(object);
+
+    return OBJECT_OVERHEAD;
+}
+
+int QpCacheData::maximumMainSegmentSize() const
+{
+    if (strongCacheSize < 0)
+        return -1;
+
+    // Reserve a fifth of the cache for the probation segment
+    return strongCacheSize - qMax(1, strongCacheSize / 5);
+}
+
+void QpCacheData::unlink(Node *node)
+{
+    Segment *segment = node->segment;
+
+    if (node->previous)
+        node->previous->next = node->next;
+    else
+        segment->head = node->next;
+
+    if (node->next)
+        node->next->previous = node->previous;
+    else
+        segment->tail = node->previous;
+
+    --segment->size;
+    node->segment = nullptr;
+    node->previous = nullptr;
+    node->next = nullptr;
+}
+
+void QpCacheData::append(Segment *segment, Node *node)
+{
+    node->segment = segment;
+    node->previous = segment->tail;
+    node->next = nullptr;
+    node->tick = pool ? ++pool->clock : 0;
+
+    if (segment->tail)
+        segment->tail->next = node;
+    else
+        segment->head = node;
+
+    segment->tail = node;
+    ++segment->size;
+}
+
+void QpCacheData::removeNode(Node *node)
+{
+    unlink(node);
+    strongCacheById.remove(node->id);
+
+    cost -= node->cost;
+    if (pool)
+        pool->cost -= node->cost;
+
+    // Deleting the node might delete the object, so the lists have to be consistent at this point
+    delete node;
+}
+
+void QpCacheData::touch(int id, QSharedPointer<QObject> object)
+{
+    Node *node = strongCacheById.value(id);
+    if (node) {
+        // Already strongly cached: move it to the most recently used end of
+        // the main segment, which promotes objects out of probation
+        if (node != mainSegment.tail) {
+            unlink(node);
+            append(&mainSegment, node);
+        }
+        else {
+            // The pool evicts by tick across all caches, so every hit has to refresh it
+            node->tick = pool ? ++pool->clock : 0;
+        }
+
+        // Demote objects from an overfull main segment back into probation
+        int maximumMainSize = maximumMainSegmentSize();
+        if (admissionPolicy == QpCache::Probation
+                && maximumMainSize >= 0) {
+            while (maximumMainSize < mainSegment.size && mainSegment.head) {
+                Node *demoted = mainSegment.head;
+                unlink(demoted);
+                append(&probationSegment, demoted);
+            }
+        }
+        return;
+    }
+
+    if (strongCacheSize == 0)
+        return;
+
+    node = new Node;
+    node->id = id;
+    node->object = object;
+    node->cost = isCostTracked() ? estimateSize(object.data()) : 0;
+    append(admissionPolicy == QpCache::Probation ? &probationSegment : &mainSegment, node);
+    strongCacheById.insert(id, node);
+
+    cost += node->cost;
+    if (pool)
+        pool->cost += node->cost;
+
+    trim();
+    if (pool)
+        pool->trim();
+}
+
+void QpCacheData::removeFromStrongCache(int id)
+{
+    Node *node = strongCacheById.value(id);
+    if (!node)
+        return;
+
+    removeNode(node);
+}
+
+QpCacheData::Node *QpCacheData::nextVictim() const
+{
+    if (probationSegment.head)
+        return probationSegment.head;
+
+    return mainSegment.head;
+}
+
+void QpCacheData::evictLeastRecentlyUsed()
+{
+    Node *victim = nextVictim();
+    if (!victim)
+        return;
+
+    evictions.fetchAndAddRelaxed(1);
+    removeNode(victim);
+}
+
+void QpCacheData::trim()
+{
+    while (nextVictim()
+           && ((strongCacheSize >= 0 && strongCacheSize < strongCacheById.size())
+               || (maximumCost >= 0 && maximumCost < cost))) {
+        evictLeastRecentlyUsed();
+    }
+}
+
+bool QpCacheData::isCostTracked() const
+{
+    return maximumCost >= 0
+            || (pool && pool->maximumCost >= 0);
+}
+
+void QpCacheData::recalculateCosts()
+{
+    bool tracked = isCostTracked();
+    qint64 previousCost = cost;
+
+    cost = 0;
+    foreach (Node *node, strongCacheById) {
+        node->cost = tracked ? estimateSize(node->object.data()) : 0;
+        cost += node->cost;
+    }
+
+    if (pool)
+        pool->cost += cost - previousCost;
+}
+
+void QpCacheData::setPool(QpCacheMemoryPoolData *newPool)
+{
+    if (pool) {
+        pool->caches.removeOne(this);
+        pool->cost -= cost;
+    }
+
+    pool = newPool;
+
+    if (pool) {
+        pool->caches.append(this);
+        pool->cost += cost;
+    }
+}
+
+
+/******************************************************************************
+ * QpCacheMemoryPool
+ */
+QpCacheMemoryPool::QpCacheMemoryPool() :
+    data(new QpCacheMemoryPoolData)
+{
+}
+
+QpCacheMemoryPool::QpCacheMemoryPool(const QpCacheMemoryPool &rhs) :
+    data(rhs.data)
+{
+}
+
+QpCacheMemoryPool &QpCacheMemoryPool::operator=(const QpCacheMemoryPool &rhs)
+{
+    if (this != &rhs)
+        data.operator=(rhs.data);
+    return *this;
+}
+
+QpCacheMemoryPool::~QpCacheMemoryPool()
+{
+}
+
+qint64 QpCacheMemoryPool::cost() const
 {
-    strongCache.append(accessedObject);
+    return data->cost;
+}
+
+qint64 QpCacheMemoryPool::maximumCost() const
+{
+    return data->maximumCost;
+}
 
-    if (strongCacheSize < strongCache.size()) {
-        strongCache.takeFirst();
+void QpCacheMemoryPool::setMaximumCost(qint64 cost)
+{
+    bool wasTracked = data->maximumCost >= 0;
+    data->maximumCost = cost;
+
+    if (!wasTracked && cost >= 0) {
+        foreach (QpCacheData *cache, data->caches) {
+            cache->recalculateCosts();
+        }
     }
+
+    data->trim();
 }
 
 
@@ -36,7 +499,6 @@ void QpCacheData::adjustQueue(QSharedPointer<QObject> accessedObject) const
 QpCache::QpCache() :
     data(new QpCacheData)
 {
-    data->strongCacheSize = 50;
 }
 
 QpCache::QpCache(const QpCache &rhs) :
@@ -70,15 +532,15 @@ QSharedPointer<QObject> QpCache::insert(int id, QObject *object)
                    .arg(id).toLatin1());
     }
 
+    data->inserts.fetchAndAddRelaxed(1);
+
+    // Drop a possibly stale entry, so that the id appears in the strong cache at most once
+    data->removeFromStrongCache(id);
+
     p = QSharedPointer<QObject>(object);
     QWeakPointer<QObject> weak = p.toWeakRef();
     data->weakCacheById.insert(id, weak);
-
-    data->strongCache.append(p);
-
-    if (data->strongCacheSize < data->strongCache.size()) {
-        data->strongCache.takeFirst();
-    }
+    data->touch(id, p);
 
     return p;
 }
@@ -86,19 +548,25 @@ QSharedPointer<QObject> QpCache::insert(int id, QObject *object)
 QSharedPointer<QObject> QpCache::get(int id) const
 {
     QSharedPointer<QObject> p = data->weakCacheById.value(id).toStrongRef();
-    if (p) {
-        data->adjustQueue(p);
+    if (!p) {
+        data->misses.fetchAndAddRelaxed(1);
+        return p;
     }
 
+    if (data->strongCacheById.contains(id))
+        data->hits.fetchAndAddRelaxed(1);
+    else
+        data->resurrections.fetchAndAddRelaxed(1);
+
+    data->touch(id, p);
     return p;
 }
 
 void QpCache::remove(int id)
 {
-    QSharedPointer<QObject> p = data->weakCacheById.take(id).toStrongRef();
-    if (p) {
-        data->strongCache.removeOne(p);
-    }
+    data->removes.fetchAndAddRelaxed(1);
+    data->weakCacheById.remove(id);
+    data->removeFromStrongCache(id);
 }
 
 int QpCache::maximumCacheSize() const
@@ -108,9 +576,92 @@ int QpCache::maximumCacheSize() const
 
 void QpCache::setMaximumCacheSize(int size)
 {
-    while (size < data->strongCache.size()) {
-        data->strongCache.takeFirst();
+    data->strongCacheSize = size;
+    data->trim();
+}
+
+qint64 QpCache::cacheCost() const
+{
+    return data->cost;
+}
+
+qint64 QpCache::maximumCacheCost() const
+{
+    return data->maximumCost;
+}
+
+void QpCache::setMaximumCacheCost(qint64 cost)
+{
+    bool wasTracked = data->isCostTracked();
+    data->maximumCost = cost;
+
+    if (!wasTracked && data->isCostTracked())
+        data->recalculateCosts();
+
+    data->trim();
+}
+
+QpCache::AdmissionPolicy QpCache::admissionPolicy() const
+{
+    return data->admissionPolicy;
+}
+
+void QpCache::setAdmissionPolicy(AdmissionPolicy policy)
+{
+    data->admissionPolicy = policy;
+}
+
+QSharedPointer<QpCacheSizeEstimator> QpCache::sizeEstimator() const
+{
+    return data->sizeEstimator;
+}
+
+void QpCache::setSizeEstimator(QSharedPointer<QpCacheSizeEstimator> estimator)
+{
+    data->sizeEstimator = estimator;
+
+    if (data->isCostTracked()) {
+        data->recalculateCosts();
+        data->trim();
+        if (data->pool)
+            data->pool->trim();
     }
+}
 
-    data->strongCacheSize = size;
+QpCacheMemoryPool QpCache::memoryPool() const
+{
+    QpCacheMemoryPool pool;
+    if (data->pool)
+        pool.data = data->pool;
+    return pool;
+}
+
+void QpCache::setMemoryPool(const QpCacheMemoryPool &pool)
+{
+    data->setPool(pool.data.data());
+    data->recalculateCosts();
+    data->trim();
+    data->pool->trim();
+}
+
+QpCacheStatistics QpCache::statistics() const
+{
+    QpCacheStatistics statistics;
+    statistics.hits = data->hits.load();
+    statistics.resurrections = data->resurrections.load();
+    statistics.misses = data->misses.load();
+    statistics.evictions = data->evictions.load();
+    statistics.inserts = data->inserts.load();
+    statistics.removes = data->removes.load();
+    return statistics;
+}
+
+void QpCache::resetStatistics()
+{
+    data->hits.store(0);
+    data->resurrections.store(0);
+    data->misses.store(0);
+    data->evictions.store(0);
+    data->inserts.store(0);
+    data->removes.store(0);
 }
@@ -3,14 +3,91 @@
 
 #include "defines.h"
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QtCore/QAtomicInteger>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QExplicitlySharedDataPointer>
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 
+#include "metaobject.h"
+
+/*!
+ * \brief The QpCacheSizeEstimator class estimates the memory an object occupies in a QpCache.
+ * Install an estimator per class with QpCache::setSizeEstimator().
+ */
+class QpCacheSizeEstimator
+{
+public:
+    virtual ~QpCacheSizeEstimator();
+    virtual qint64 estimateSize(const QObject *object) const = 0;
+};
+
+/*!
+ * \brief The QpDefaultCacheSizeEstimator class sums up the sizes of the simple properties of an object.
+ */
+class QpDefaultCacheSizeEstimator : public QpCacheSizeEstimator
+{
+public:
+    explicit QpDefaultCacheSizeEstimator(const QpMetaObject &metaObject);
+    ~QpDefaultCacheSizeEstimator();
+
+    qint64 estimateSize(const QObject *object) const Q_DECL_OVERRIDE;
+
+    static qint64 estimateSize(const QVariant &value);
+
+private:
+    QpMetaObject m_metaObject;
+};
+
+/*!
+ * \brief The QpCacheMemoryPool class is a memory budget, which is shared by multiple caches.
+ * When the pool exceeds its maximum cost, the least recently used object of all caches in the pool gets evicted.
+ */
+class QpCacheMemoryPoolData;
+class QpCacheMemoryPool
+{
+public:
+    QpCacheMemoryPool();
+    QpCacheMemoryPool(const QpCacheMemoryPool &);
+    QpCacheMemoryPool &operator=(const QpCacheMemoryPool &);
+    ~QpCacheMemoryPool();
+
+    qint64 cost() const;
+    qint64 maximumCost() const; //! -1 means unlimited
+    void setMaximumCost(qint64 cost);
+
+private:
+    friend class QpCache;
+    QExplicitlySharedDataPointer<QpCacheMemoryPoolData> data;
+};
+
+/*!
+ * \brief The QpCacheStatistics struct is a snapshot of the counters of one or more caches.
+ */
+struct QpCacheStatistics
+{
+    QpCacheStatistics();
+
+    quint64 hits;          //! get() found a strongly cached object
+    quint64 resurrections; //! get() found an object, which was only weakly referenced anymore
+    quint64 misses;        //! get() did not find an object
+    quint64 evictions;     //! An object was dropped from the strong cache to meet its limits
+    quint64 inserts;
+    quint64 removes;
+
+    double hitRatio() const;
+
+    QpCacheStatistics &operator+=(const QpCacheStatistics &rhs);
+};
+
 class QpCacheData;
 class QpCache
 {
 public:
+    enum AdmissionPolicy {
+        AdmitAll,   //! Every object enters the strongly cached LRU list
+        Probation   //! New objects have to be accessed twice to be protected from bulk reads
+    };
+
     QpCache();
     QpCache(const QpCache &);
     QpCache &operator=(const QpCache &);
@@ -21,9 +98,25 @@ public:
     QSharedPointer<QObject> get(int id) const;
     void remove(int id);
 
-    int maximumCacheSize() const;
+    int maximumCacheSize() const; //! -1 means unlimited
     void setMaximumCacheSize(int size);
 
+    AdmissionPolicy admissionPolicy() const;
+    void setAdmissionPolicy(AdmissionPolicy policy);
+
+    qint64 cacheCost() const;
+    qint64 maximumCacheCost() const; //! -1 means unlimited
+    void setMaximumCacheCost(qint64 cost);
+
+    QSharedPointer<QpCacheSizeEstimator> sizeEstimator() const;
+    void setSizeEstimator(QSharedPointer<QpCacheSizeEstimator> estimator);
+
+    QpCacheMemoryPool memoryPool() const;
+    void setMemoryPool(const QpCacheMemoryPool &pool);
+
+    QpCacheStatistics statistics() const;
+    void resetStatistics();
+
 private:
     QExplicitlySharedDataPointer<QpCacheData> data;
 };
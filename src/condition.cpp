@@ -54,11 +54,16 @@ QpCondition QpCondition::notDeletedAnd(const QpCondition &additionalConditions)
 
 QpCondition QpCondition::primaryKeys(const QList<int> &primaryKeys)
 {
-    QList<QpCondition> conditions;
+    // An empty list of keys has always been an invalid condition
+    if (primaryKeys.isEmpty())
+        return QpCondition();
+
+    QVariantList keys;
+    keys.reserve(primaryKeys.size());
     foreach(int primaryKey, primaryKeys) {
-        conditions << QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, EqualTo, primaryKey);
+        keys << primaryKey;
     }
-    return QpCondition(Or, conditions);
+    return QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, In, keys);
 }
 
 QpCondition::QpCondition() :
@@ -192,8 +197,24 @@ QString QpCondition::toSqlClause() const
     Q_ASSERT(!data->field.isEmpty());
 
     QString value = "?";
-    if (data->bindValues)
+    if (data->comparisonOperator == In
+        || data->comparisonOperator == NotIn) {
+        QVariantList list = data->value.toList();
+
+        // "IN ()" is no valid SQL
+        if (list.isEmpty())
+            return data->comparisonOperator == In ? QString("1 = 0") : QString("1 = 1");
+
+        QStringList values;
+        values.reserve(list.size());
+        foreach (const QVariant &v, list) {
+            values.append(data->bindValues ? v.toString() : QString("?"));
+        }
+        value = QString("(%1)").arg(values.join(", "));
+    }
+    else if (data->bindValues) {
         value = data->value.toString();
+    }
 
     if (!data->table.isEmpty()
         && !data->field.contains('.')) {
@@ -223,12 +244,58 @@ QVariantList QpCondition::bindValues() const
         result.append(condition.bindValues());
     }
 
-    if (!data->field.isEmpty())
+    if (data->field.isEmpty())
+        return result;
+
+    if (data->comparisonOperator == In
+        || data->comparisonOperator == NotIn)
+        result.append(data->value.toList());
+    else
         result.append(data->value);
 
     return result;
 }
 
+//! Splits the condition at its IN lists, which have more than \a maximumValueCount values.
+//! The union of the results of the returned conditions is the result of this condition.
+QList<QpCondition> QpCondition::splitInLists(int maximumValueCount) const
+{
+    QList<QpCondition> result;
+
+    if (!data->field.isEmpty()
+        && data->comparisonOperator == In) {
+        QVariantList values = data->value.toList();
+        if (maximumValueCount <= 0 || values.size() <= maximumValueCount)
+            return result << *this;
+
+        for (int i = 0; i < values.size(); i += maximumValueCount) {
+            QpCondition part = *this;
+            part.data->value = values.mid(i, maximumValueCount);
+            result << part;
+        }
+        return result;
+    }
+
+    // NOT (a OR b) is not the union of NOT a and NOT b
+    if (data->booleanOperator != Not) {
+        for (int i = 0; i < data->conditions.size(); ++i) {
+            QList<QpCondition> parts = data->conditions.at(i).splitInLists(maximumValueCount);
+            if (parts.size() <= 1)
+                continue;
+
+            // Split the remaining IN lists of each part as well
+            foreach (const QpCondition &part, parts) {
+                QpCondition condition = *this;
+                condition.data->conditions[i] = part;
+                result << condition.splitInLists(maximumValueCount);
+            }
+            return result;
+        }
+    }
+
+    return result << *this;
+}
+
 QpCondition::BooleanOperator QpCondition::booleanOperator() const
 {
     return data->booleanOperator;
@@ -269,6 +336,10 @@ QString QpCondition::comparisonOperatorSqlString() const
         return " <= ";
     case NotEqualTo:
         return " <> ";
+    case In:
+        return " IN ";
+    case NotIn:
+        return " NOT IN ";
     }
 
     Q_ASSERT(false);
@@ -26,7 +26,9 @@ public:
         LessThan,
         GreaterThanOrEqualTo,
         LessThanOrEqualTo,
-        NotEqualTo
+        NotEqualTo,
+        In,     // the value is a QVariantList
+        NotIn   // the value is a QVariantList
     };
 
     static QpCondition notDeletedAnd(const QpCondition &additionalConditions = QpCondition());
@@ -53,6 +55,8 @@ public:
     QString toSqlClause() const;
     QVariantList bindValues() const;
 
+    QList<QpCondition> splitInLists(int maximumValueCount) const;
+
     BooleanOperator booleanOperator() const;
     QString booleanOperatorSqlString() const;
     ComparisonOperator comparisonOperator() const;
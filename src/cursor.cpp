@@ -0,0 +1,112 @@
+#include "cursor.h"
+
+#include "dataaccessobject.h"
+#include "datasource.h"
+#include "datasourceresult.h"
+#include "error.h"
+#include "storage.h"
+
+BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QSharedData>
+END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+
+/******************************************************************************
+ * QpCursorData
+ */
+class QpCursorData : public QSharedData
+{
+public:
+    QpCursorData() :
+        QSharedData(),
+        dataAccessObject(nullptr),
+        batchSize(0),
+        atEnd(true)
+    {
+    }
+
+    const QpDataAccessObjectBase *dataAccessObject;
+    QScopedPointer<QpDatasourceCursor> cursor;
+    int batchSize;
+    bool atEnd;
+    QpError error;
+};
+
+
+/******************************************************************************
+ * QpCursorBase
+ */
+QpCursorBase::QpCursorBase() :
+    data(new QpCursorData)
+{
+}
+
+QpCursorBase::QpCursorBase(const QpDataAccessObjectBase *dataAccessObject, QpDatasourceCursor *cursor, int batchSize, const QpError &error) :
+    data(new QpCursorData)
+{
+    data->dataAccessObject = dataAccessObject;
+    data->cursor.reset(cursor);
+    data->batchSize = qMax(1, batchSize);
+    data->atEnd = !cursor;
+    data->error = error;
+}
+
+QpCursorBase::QpCursorBase(const QpCursorBase &rhs) :
+    data(rhs.data)
+{
+}
+
+QpCursorBase &QpCursorBase::operator=(const QpCursorBase &rhs)
+{
+    if (this != &rhs)
+        data.operator=(rhs.data);
+
+    return *this;
+}
+
+QpCursorBase::~QpCursorBase()
+{
+}
+
+bool QpCursorBase::isValid() const
+{
+    return data->dataAccessObject && !data->error.isValid();
+}
+
+bool QpCursorBase::atEnd() const
+{
+    return data->atEnd;
+}
+
+int QpCursorBase::batchSize() const
+{
+    return data->batchSize;
+}
+
+QpError QpCursorBase::lastError() const
+{
+    return data->error;
+}
+
+QList<QSharedPointer<QObject> > QpCursorBase::next()
+{
+    if (data->atEnd)
+        return {};
+
+    QpDatasourceResult result(data->dataAccessObject);
+    data->cursor->fetch(&result, data->batchSize);
+
+    if (result.lastError().isValid()) {
+        data->error = result.lastError();
+        data->atEnd = true;
+        data->cursor.reset();
+        return {};
+    }
+
+    // Close the statement as soon as it has been read completely
+    if (result.size() < data->batchSize) {
+        data->atEnd = true;
+        data->cursor.reset();
+    }
+
+    return data->dataAccessObject->readObjects(&result);
+}
@@ -0,0 +1,58 @@
+#ifndef QPERSISTENCE_CURSOR_H
+#define QPERSISTENCE_CURSOR_H
+
+#include "defines.h"
+BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QtCore/QExplicitlySharedDataPointer>
+#include <QtCore/QSharedPointer>
+END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+
+#include "qpersistence.h"
+
+class QpDataAccessObjectBase;
+class QpDatasourceCursor;
+class QpError;
+
+/*!
+ * \brief The QpCursorBase class reads the objects of a query in fixed-size batches.
+ * The statement stays open until the last copy of the cursor is destroyed, so that
+ * only one batch of objects has to be kept in memory at a time.
+ */
+class QpCursorData;
+class QpCursorBase
+{
+public:
+    QpCursorBase();
+    QpCursorBase(const QpCursorBase &);
+    QpCursorBase &operator=(const QpCursorBase &);
+    ~QpCursorBase();
+
+    bool isValid() const;
+    bool atEnd() const;
+    int batchSize() const;
+    QpError lastError() const;
+
+    QList<QSharedPointer<QObject> > next(); //! The next batch of objects. Empty, if the cursor is at its end.
+
+private:
+    friend class QpDataAccessObjectBase;
+    QpCursorBase(const QpDataAccessObjectBase *dataAccessObject, QpDatasourceCursor *cursor, int batchSize, const QpError &error);
+
+    QExplicitlySharedDataPointer<QpCursorData> data;
+};
+
+template<class T>
+class QpCursor : public QpCursorBase
+{
+public:
+    QpCursor() : QpCursorBase() {
+    }
+    QpCursor(const QpCursorBase &other) : QpCursorBase(other) {
+    }
+
+    QList<QSharedPointer<T> > next() {
+        return Qp::castList<T>(QpCursorBase::next());
+    }
+};
+
+#endif // QPERSISTENCE_CURSOR_H
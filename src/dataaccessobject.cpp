@@ -1,6 +1,7 @@
 #include "dataaccessobject.h"
 
 #include "cache.h"
+#include "cursor.h"
 #include "databaseschema.h"
 #include "datasource.h"
 #include "datasourceresult.h"
@@ -17,6 +18,7 @@
 #include "transactionshelper.h"
 
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QSet>
 #include <QSqlError>
 #include <QSqlRecord>
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
@@ -40,8 +42,37 @@ public:
     mutable QpCache cache;
     int lastSynchronizedCreatedId;
     int lastSynchronizedRevision;
+
+    // Objects, which are written, when the storage commits its bulk database queries
+    QList<QSharedPointer<QObject> > bulkUpdates;
+    QSet<QObject *> bulkUpdateObjects;
+    QList<QSharedPointer<QObject> > bulkRemovals;
+    // Objects and their new state, which are written back, when the transaction has been committed
+    QList<QPair<QSharedPointer<QObject>, QpDataTransferObject> > bulkWrittenObjects;
+    // Objects, which are unlinked from their relations, when the transaction has been committed
+    QList<QSharedPointer<QObject> > bulkMarkedAsDeleted;
+    QList<QSharedPointer<QObject> > bulkUndeleted;
+    // The next and the last value of the block, which has been reserved for each sequence
+    QHash<QString, QPair<int, int> > sequenceBlocks;
+
+    static QpCondition seekCondition(const QVariant &lastKey, const QpCondition &condition, QpDatasource::OrderField &key);
 };
 
+QpCondition QpDataAccessObjectBaseData::seekCondition(const QVariant &lastKey, const QpCondition &condition, QpDatasource::OrderField &key)
+{
+    if (key.field.isEmpty()) {
+        key.field = QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY;
+        key.order = QpDatasource::Ascending;
+    }
+
+    if (!lastKey.isValid())
+        return condition;
+
+    QpCondition::ComparisonOperator comparison = key.order == QpDatasource::Ascending ? QpCondition::GreaterThan
+                                                                                       : QpCondition::LessThan;
+    return QpCondition(key.field, comparison, lastKey) && condition;
+}
+
 
 /******************************************************************************
  * QpDataAccessObjectBase
@@ -53,6 +84,7 @@ QpDataAccessObjectBase::QpDataAccessObjectBase(const QMetaObject &metaObject,
 {
     data->storage = parent;
     data->metaObject = QpMetaObject::registerMetaObject(metaObject);
+    data->cache.setSizeEstimator(QSharedPointer<QpCacheSizeEstimator>(new QpDefaultCacheSizeEstimator(data->metaObject)));
 }
 
 void QpDataAccessObjectBase::handleResultError()
@@ -132,6 +164,11 @@ QpReply *QpDataAccessObjectBase::makeReply(QpDatasourceResult *result, std::func
 {
     QpReply *reply = new QpReply(result, const_cast<QpDataAccessObjectBase *>(this));
     connect(result, &QpDatasourceResult::error, this, &QpDataAccessObjectBase::handleResultError);
+    // Failed results never finish, but their replies do
+    connect(result, &QpDatasourceResult::error, reply, [reply](const QpError &error) {
+        reply->setLastError(error);
+        reply->finish();
+    });
     connect(result, &QpDatasourceResult::finished, [=] {
         handleResult(result, reply);
         result->deleteLater();
@@ -152,6 +189,17 @@ int QpDataAccessObjectBase::count(const QpCondition &condition) const
     return result.integerResult();
 }
 
+/*!
+ * Estimates the number of objects in the table without counting them. Deleted
+ * objects may be included.
+ */
+int QpDataAccessObjectBase::approximateCount() const
+{
+    QpDatasourceResult result(this);
+    data->storage->datasource()->approximateCount(&result, data->metaObject);
+    return result.integerResult();
+}
+
 QList<QSharedPointer<QObject> > QpDataAccessObjectBase::readAllObjects(int skip, int limit, const QpCondition &condition, QList<QpDatasource::OrderField> orders) const
 {
     QpDatasourceResult result(this);
@@ -159,10 +207,40 @@ QList<QSharedPointer<QObject> > QpDataAccessObjectBase::readAllObjects(int skip,
     return readObjects(&result);
 }
 
+/*!
+ * Reads the next \a limit objects after the object, whose \a key field has the
+ * value \a lastKey, with a "WHERE key > lastKey" condition instead of an offset,
+ * which the database would have to skip row by row. The key has to be unique and
+ * defaults to the primary key. An invalid \a lastKey reads the first page.
+ */
+QList<QSharedPointer<QObject> > QpDataAccessObjectBase::readAllObjectsAfter(const QVariant &lastKey, int limit, const QpCondition &condition, QpDatasource::OrderField key) const
+{
+    QpCondition seekCondition = QpDataAccessObjectBaseData::seekCondition(lastKey, condition, key);
+    return readAllObjects(-1, limit, seekCondition, QList<QpDatasource::OrderField>() << key);
+}
+
+QpReply *QpDataAccessObjectBase::readAllObjectsAfterAsync(const QVariant &lastKey, int limit, const QpCondition &condition, QpDatasource::OrderField key) const
+{
+    QpCondition seekCondition = QpDataAccessObjectBaseData::seekCondition(lastKey, condition, key);
+    return readAllObjectsAsync(-1, limit, seekCondition, QList<QpDatasource::OrderField>() << key);
+}
+
+/*!
+ * Opens a cursor, which reads the objects in batches of \a batchSize from a
+ * statement, which stays open, instead of reading all of them at once.
+ */
+QpCursorBase QpDataAccessObjectBase::openCursor(const QpCondition &condition, QList<QpDatasource::OrderField> orders, int batchSize) const
+{
+    QpDatasourceResult result(this);
+    QpDatasourceCursor *cursor = data->storage->datasource()->openCursor(&result, data->metaObject, condition, orders);
+    return QpCursorBase(this, cursor, batchSize, result.lastError());
+}
+
 QpReply *QpDataAccessObjectBase::readAllObjectsAsync(int skip, int limit, const QpCondition &condition, QList<QpDatasource::OrderField> orders) const
 {
     QpDatasourceResult *result = new QpDatasourceResult(this);
-    QMetaObject::invokeMethod(data->storage->asynchronousDatasource(), "objects",
+    // Pages can be read in parallel, because every reply delivers its own objects
+    QMetaObject::invokeMethod(data->storage->asynchronousDatasource(result), "objects",
                               Q_ARG(QpDatasourceResult *, result),
                               Q_ARG(QpMetaObject, data->metaObject),
                               Q_ARG(int, skip),
@@ -205,7 +283,8 @@ QList<QSharedPointer<QObject> > QpDataAccessObjectBase::readObjectsUpdatedAfterR
 QpReply *QpDataAccessObjectBase::readObjectsUpdatedAfterRevisionAsync(int revision) const
 {
     QpDatasourceResult *result = new QpDatasourceResult(this);
-    QMetaObject::invokeMethod(data->storage->asynchronousDatasource(), "objectsUpdatedAfterRevision",
+    // Synchronizations must not overtake each other
+    QMetaObject::invokeMethod(data->storage->asynchronousDatasource(result, this), "objectsUpdatedAfterRevision",
                               Q_ARG(QpDatasourceResult *, result),
                               Q_ARG(QpMetaObject, data->metaObject),
                               Q_ARG(int, revision));
@@ -305,40 +384,180 @@ QSharedPointer<QObject> QpDataAccessObjectBase::createObject()
     return obj;
 }
 
+QList<QSharedPointer<QObject> > QpDataAccessObjectBase::createObjects(int count)
+{
+    QList<QObject *> objects;
+    objects.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        objects.append(createInstance());
+    }
+
+    return insertObjects(objects);
+}
+
+/*!
+ * Inserts \a objects, which have been created with createInstance(), with as
+ * few statements as possible in one transaction. All objects are inserted or
+ * none.
+ *
+ * The data access object takes ownership of \a objects: On success the returned
+ * shared pointers manage them, on failure they are deleted and an empty list is
+ * returned.
+ */
+QList<QSharedPointer<QObject> > QpDataAccessObjectBase::insertObjects(const QList<QObject *> &objects)
+{
+    if (objects.isEmpty())
+        return {};
+
+    // Block signals, so that no signals are emitted for partly-initialized objects
+    foreach (QObject *object, objects) {
+        object->blockSignals(true);
+    }
+
+    // All chunks are inserted or none
+    if (!data->storage->beginTransaction()) {
+        qDeleteAll(objects);
+        return {};
+    }
+
+    QpDatasourceResult result(this);
+    data->storage->datasource()->insertObjects(&result, objects);
+
+    if (result.lastError().isValid()) {
+        data->storage->rollbackTransaction();
+        qDeleteAll(objects);
+        return {};
+    }
+
+    // The datasource reports one data transfer object per object, in the order of the objects
+    QList<QpDataTransferObject> dataTransferObjects = result.dataTransferObjects();
+    if (dataTransferObjects.size() != objects.size()) {
+        data->storage->setLastError(QpError(QString::fromLatin1("The datasource has reported %1 data transfer objects for %2 inserted objects")
+                                            .arg(dataTransferObjects.size())
+                                            .arg(objects.size()),
+                                            QpError::SqlError));
+        data->storage->rollbackTransaction();
+        qDeleteAll(objects);
+        return {};
+    }
+
+    if (!data->storage->commitOrRollbackTransaction()) {
+        qDeleteAll(objects);
+        return {};
+    }
+
+    QList<QSharedPointer<QObject> > createdObjects;
+    createdObjects.reserve(objects.size());
+    for (int i = 0; i < objects.size(); ++i) {
+        QObject *object = objects.at(i);
+        dataTransferObjects.at(i).write(object);
+
+        QSharedPointer<QObject> obj = setupSharedObject(object, dataTransferObjects.at(i).primaryKey);
+        object->blockSignals(false);
+        emit objectInstanceCreated(obj);
+        createdObjects.append(obj);
+    }
+
+    foreach (QSharedPointer<QObject> obj, createdObjects) {
+        emit objectCreated(obj);
+    }
+
+    return createdObjects;
+}
+
 Qp::UpdateResult QpDataAccessObjectBase::updateObject(QSharedPointer<QObject> object)
+{
+    return updateObject(object, 0, false);
+}
+
+/*!
+ * \internal
+ * With \a deferWriteBack the new state of the object is queued instead of
+ * written back and the signal is emitted by finishBulkDatabaseQueries().
+ */
+Qp::UpdateResult QpDataAccessObjectBase::updateObject(QSharedPointer<QObject> object, int rebaseCount, bool deferWriteBack)
 {
     QObject *obj = object.data();
-    int localRevision = Qp::Private::revisionInObject(obj);
-    int remoteRevision = revisionInDatabase(object);
 
-    if (localRevision < remoteRevision) {
-        Qp::SynchronizeResult syncResult = sync(object, RebaseMode);
-        if(syncResult == Qp::Updated)
-            return updateObject(object);
-        else if(syncResult == Qp::RebaseConflict)
-            return Qp::UpdateConflict;
-        else
-            return Qp::UpdateError;
+    // The last state of the object is written, when the bulk database queries are committed
+    if (data->storage->isBulkDatabaseQueriesStarted()) {
+        if (!data->bulkUpdateObjects.contains(obj)) {
+            data->bulkUpdateObjects.insert(obj);
+            data->bulkUpdates.append(object);
+        }
+        return Qp::UpdateSuccess;
+    }
+
+    // Nothing to do, if the object has not changed since it has been read or written the last time
+    if (!QpDataTransferObject::fromObject(obj).isEmpty()
+        && !QpDataTransferObject::changesInObject(obj).hasChanges()) {
+        return Qp::UpdateSuccess;
     }
 
-    Q_ASSERT(localRevision == remoteRevision);
+    // With optimistic concurrency the UPDATE itself detects conflicts, so we do not have to check the revision first
+    bool optimistic = QpDataTransferObject::fromObject(obj).dynamicProperties.contains(QpDatabaseSchema::COLUMN_NAME_VERSION);
+    if (!optimistic) {
+        int localRevision = Qp::Private::revisionInObject(obj);
+        int remoteRevision = revisionInDatabase(object);
+
+        if (localRevision < remoteRevision)
+            return rebaseAndUpdate(object, rebaseCount, deferWriteBack);
+
+        Q_ASSERT(localRevision == remoteRevision);
+    }
 
     QpDatasourceResult result(this);
     data->storage->datasource()->updateObject(&result, obj);
     if (result.lastError().isValid())
         return Qp::UpdateError;
 
+    if (optimistic && result.integerResult() == 0)
+        return rebaseAndUpdate(object, rebaseCount, deferWriteBack);
+
     if (result.isEmpty() && Qp::Private::isDeleted(object))
         return Qp::UpdateSuccess;
 
+    if (deferWriteBack) {
+        data->bulkWrittenObjects.append(qMakePair(object, result.dataTransferObjects().first()));
+        return Qp::UpdateSuccess;
+    }
+
     emit objectUpdated(object);
     result.dataTransferObjects().first().write(obj);
 
     return Qp::UpdateSuccess;
 }
 
+Qp::UpdateResult QpDataAccessObjectBase::rebaseAndUpdate(QSharedPointer<QObject> object, int rebaseCount, bool deferWriteBack)
+{
+    // Others might keep changing the object between our rebase and our update
+    static const int MAXIMUM_REBASE_COUNT = 10;
+    if (rebaseCount >= MAXIMUM_REBASE_COUNT) {
+        data->storage->setLastError(QpError(QString::fromLatin1("The object has been changed by someone else %1 times in a row")
+                                            .arg(MAXIMUM_REBASE_COUNT),
+                                            QpError::UpdateConflictError));
+        return Qp::UpdateError;
+    }
+
+    Qp::SynchronizeResult syncResult = sync(object, RebaseMode);
+    if(syncResult == Qp::Updated)
+        return updateObject(object, rebaseCount + 1, deferWriteBack);
+    else if(syncResult == Qp::RebaseConflict)
+        return Qp::UpdateConflict;
+    else
+        return Qp::UpdateError;
+}
+
 bool QpDataAccessObjectBase::removeObject(QSharedPointer<QObject> object)
 {
+    // The object is unlinked and evicted, when the bulk database queries have been committed
+    if (data->storage->isBulkDatabaseQueriesStarted()) {
+        if (data->bulkUpdateObjects.remove(object.data()))
+            data->bulkUpdates.removeAll(object);
+        data->bulkRemovals.append(object);
+        return true;
+    }
+
     // We have to unlink all related objects, because otherwise the
     // object will still be referenced by all strong relations.
     // If I ever want to delete this line (again), I will have a look at the
@@ -357,6 +576,140 @@ bool QpDataAccessObjectBase::removeObject(QSharedPointer<QObject> object)
     return true;
 }
 
+bool QpDataAccessObjectBase::writeBulkDatabaseQueries()
+{
+    QList<QSharedPointer<QObject> > updates = data->bulkUpdates;
+    QList<QSharedPointer<QObject> > removals = data->bulkRemovals;
+    QList<QSharedPointer<QObject> > markedAsDeleted = data->bulkMarkedAsDeleted;
+    QList<QSharedPointer<QObject> > undeleted = data->bulkUndeleted;
+    clearBulkDatabaseQueries();
+    data->bulkRemovals = removals;
+    data->bulkMarkedAsDeleted = markedAsDeleted;
+    data->bulkUndeleted = undeleted;
+
+    // The revisions of all objects without optimistic concurrency are read at once
+    QList<QSharedPointer<QObject> > changed;
+    QList<int> revisionKeys;
+    foreach (QSharedPointer<QObject> object, updates) {
+        QObject *obj = object.data();
+        if (!QpDataTransferObject::fromObject(obj).isEmpty()
+            && !QpDataTransferObject::changesInObject(obj).hasChanges()) {
+            continue;
+        }
+
+        changed.append(object);
+        if (!QpDataTransferObject::fromObject(obj).dynamicProperties.contains(QpDatabaseSchema::COLUMN_NAME_VERSION))
+            revisionKeys.append(Qp::Private::primaryKey(obj));
+    }
+
+    QpDataTransferObjectsById revisions;
+    if (!revisionKeys.isEmpty()) {
+        QpDatasourceResult result(this);
+        data->storage->datasource()->objectRevisions(&result, data->metaObject, revisionKeys);
+        if (result.lastError().isValid())
+            return false;
+        revisions = result.dataTransferObjectsById();
+    }
+
+    QList<QSharedPointer<QObject> > batch;
+    foreach (QSharedPointer<QObject> object, changed) {
+        QObject *obj = object.data();
+
+        // Conflicts are detected per object: Optimistic concurrency needs the number of
+        // updated rows of each UPDATE and outdated objects have to be rebased first.
+        bool optimistic = QpDataTransferObject::fromObject(obj).dynamicProperties.contains(QpDatabaseSchema::COLUMN_NAME_VERSION);
+        if (optimistic || Qp::Private::revisionInObject(obj) < revisions.value(Qp::Private::primaryKey(obj)).revision()) {
+            Qp::UpdateResult result = updateObject(object, 0, true);
+            if (result == Qp::UpdateConflict)
+                data->storage->setLastError(QpError("The object has been changed by someone else", QpError::UpdateConflictError));
+            if (result != Qp::UpdateSuccess)
+                return false;
+            continue;
+        }
+
+        batch.append(object);
+    }
+
+    if (!batch.isEmpty()) {
+        QList<QObject *> objects;
+        objects.reserve(batch.size());
+        foreach (QSharedPointer<QObject> object, batch) {
+            objects.append(object.data());
+        }
+
+        QpDatasourceResult result(this);
+        data->storage->datasource()->updateObjects(&result, objects);
+        if (result.lastError().isValid())
+            return false;
+
+        // The objects are written back, when the transaction has been committed
+        QpDataTransferObjectsById dataTransferObjects = result.dataTransferObjectsById();
+        foreach (QSharedPointer<QObject> object, batch) {
+            auto it = dataTransferObjects.constFind(Qp::Private::primaryKey(object.data()));
+            if (it != dataTransferObjects.constEnd())
+                data->bulkWrittenObjects.append(qMakePair(object, it.value()));
+        }
+    }
+
+    if (!removals.isEmpty()) {
+        QList<QObject *> objects;
+        objects.reserve(removals.size());
+        foreach (QSharedPointer<QObject> object, removals) {
+            objects.append(object.data());
+        }
+
+        QpDatasourceResult result(this);
+        data->storage->datasource()->removeObjects(&result, objects);
+        if (result.lastError().isValid())
+            return false;
+    }
+
+    return true;
+}
+
+void QpDataAccessObjectBase::finishBulkDatabaseQueries()
+{
+    QList<QPair<QSharedPointer<QObject>, QpDataTransferObject> > writtenObjects = data->bulkWrittenObjects;
+    QList<QSharedPointer<QObject> > removals = data->bulkRemovals;
+    QList<QSharedPointer<QObject> > markedAsDeleted = data->bulkMarkedAsDeleted;
+    QList<QSharedPointer<QObject> > undeleted = data->bulkUndeleted;
+    clearBulkDatabaseQueries();
+
+    // Undeleted objects emit objectUndeleted() instead of objectUpdated()
+    typedef QPair<QSharedPointer<QObject>, QpDataTransferObject> WrittenObject;
+    foreach (const WrittenObject &written, writtenObjects) {
+        if (!undeleted.contains(written.first))
+            emit objectUpdated(written.first);
+        written.second.write(written.first.data());
+    }
+
+    foreach (QSharedPointer<QObject> object, undeleted) {
+        emit objectUndeleted(object);
+    }
+
+    // See comment in removeObject for unlinkRelations
+    foreach (QSharedPointer<QObject> object, markedAsDeleted) {
+        unlinkRelations(object);
+        emit objectMarkedAsDeleted(object);
+    }
+
+    foreach (QSharedPointer<QObject> object, removals) {
+        unlinkRelations(object);
+        data->cache.remove(data->storage->primaryKey(object));
+        emit objectRemoved(object);
+    }
+}
+
+void QpDataAccessObjectBase::clearBulkDatabaseQueries()
+{
+    data->bulkUpdates.clear();
+    data->bulkUpdateObjects.clear();
+    data->bulkRemovals.clear();
+    data->bulkWrittenObjects.clear();
+    data->bulkMarkedAsDeleted.clear();
+    data->bulkUndeleted.clear();
+}
+
 bool QpDataAccessObjectBase::markAsDeleted(QSharedPointer<QObject> object)
 {
     Qp::Private::markAsDeleted(object.data());
@@ -364,6 +717,11 @@ bool QpDataAccessObjectBase::markAsDeleted(QSharedPointer<QObject> object)
     if (result != Qp::UpdateSuccess)
         return false;
 
+    if (data->storage->isBulkDatabaseQueriesStarted()) {
+        data->bulkMarkedAsDeleted.append(object);
+        return true;
+    }
+
     // See comment in removeObject for unlinkRelations
     unlinkRelations(object);
 
@@ -405,6 +763,11 @@ bool QpDataAccessObjectBase::undelete(QSharedPointer<QObject> object)
     if (result != Qp::UpdateSuccess)
         return false;
 
+    if (data->storage->isBulkDatabaseQueriesStarted()) {
+        data->bulkUndeleted.append(object);
+        return true;
+    }
+
     emit objectUndeleted(object);
     return true;
 }
@@ -500,6 +863,31 @@ bool QpDataAccessObjectBase::incrementNumericColumn(QSharedPointer<QObject> obje
     return true;
 }
 
+int QpDataAccessObjectBase::nextValue(const QString &fieldName, bool *ok)
+{
+    if (ok)
+        *ok = false;
+
+    QString columnName = data->metaObject.metaProperty(fieldName).columnName();
+    auto block = data->sequenceBlocks.find(columnName);
+
+    // Only an exhausted block costs a round trip to the database
+    if (block == data->sequenceBlocks.end() || block->first > block->second) {
+        int blockSize = data->storage->sequenceBlockSize();
+        QpDatasourceResult result(this);
+        data->storage->datasource()->reserveSequenceValues(&result, data->metaObject, columnName, blockSize);
+        if (result.lastError().isValid())
+            return -1;
+
+        int lastValue = result.integerResult();
+        block = data->sequenceBlocks.insert(columnName, qMakePair(lastValue - blockSize + 1, lastValue));
+    }
+
+    if (ok)
+        *ok = true;
+    return block->first++;
+}
+
 #ifndef QP_NO_TIMESTAMPS
 QList<QSharedPointer<QObject> > QpDataAccessObjectBase::createdSince(const QDateTime &time)
 {
@@ -12,6 +12,7 @@ END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 #include <functional>
 
 #include "conversion.h"
+#include "cursor.h"
 #include "metaobject.h"
 #include "condition.h"
 #include "datasource.h"
@@ -39,15 +40,25 @@ public:
     QpMetaObject qpMetaObject() const;
 
     int count(const QpCondition &condition = QpCondition()) const;
+    int approximateCount() const;
     QList<int> allKeys(int skip = -1, int count = -1) const;
     QList<QSharedPointer<QObject> > readAllObjects(int skip = -1,
                                                    int limit = -1,
                                                    const QpCondition &condition = QpCondition(),
                                                    QList<QpDatasource::OrderField> orders = QList<QpDatasource::OrderField>()) const;
+    QList<QSharedPointer<QObject> > readAllObjectsAfter(const QVariant &lastKey,
+                                                        int limit,
+                                                        const QpCondition &condition = QpCondition(),
+                                                        QpDatasource::OrderField key = QpDatasource::OrderField()) const;
     QList<QSharedPointer<QObject> > readObjectsUpdatedAfterRevision(int revision) const;
+    QpCursorBase openCursor(const QpCondition &condition = QpCondition(),
+                            QList<QpDatasource::OrderField> orders = QList<QpDatasource::OrderField>(),
+                            int batchSize = 1000) const;
     QList<QSharedPointer<QObject> > readAllObjects(const QList<int> primaryKeys) const;
     QSharedPointer<QObject> readObject(int id) const;
     QSharedPointer<QObject> createObject();
+    QList<QSharedPointer<QObject> > createObjects(int count);
+    QList<QSharedPointer<QObject> > insertObjects(const QList<QObject *> &objects);
     Qp::UpdateResult updateObject(QSharedPointer<QObject> object);
     bool removeObject(QSharedPointer<QObject> object);
     bool markAsDeleted(QSharedPointer<QObject> object);
@@ -56,6 +67,7 @@ public:
     Qp::SynchronizeResult synchronizeObject(QSharedPointer<QObject> object, SynchronizeMode mode = NormalMode);
     int revisionInDatabase(QSharedPointer<QObject> object);
     bool incrementNumericColumn(QSharedPointer<QObject> object, const QString &fieldName);
+    int nextValue(const QString &fieldName, bool *ok = nullptr);
 
 #ifndef QP_NO_TIMESTAMPS
     QList<QSharedPointer<QObject> > createdSince(const QDateTime &time);
@@ -74,6 +86,10 @@ public:
                                  int limit = -1,
                                  const QpCondition &condition = QpCondition(),
                                  QList<QpDatasource::OrderField> orders = {}) const;
+    QpReply *readAllObjectsAfterAsync(const QVariant &lastKey,
+                                      int limit,
+                                      const QpCondition &condition = QpCondition(),
+                                      QpDatasource::OrderField key = QpDatasource::OrderField()) const;
     QpReply *readObjectsUpdatedAfterRevisionAsync(int revision) const;
 
 public slots:
@@ -99,14 +115,21 @@ private slots:
     void handleResultError();
 
 private:
+    friend class QpCursorBase;
+    friend class QpStorage;
     QSharedDataPointer<QpDataAccessObjectBaseData> data;
 
     void unlinkRelations(QSharedPointer<QObject> object) const;
     QSharedPointer<QObject> setupSharedObject(QObject *object, int id) const;
     Qp::SynchronizeResult sync(QSharedPointer<QObject> object, SynchronizeMode mode = NormalMode);
+    Qp::UpdateResult updateObject(QSharedPointer<QObject> object, int rebaseCount, bool deferWriteBack);
+    Qp::UpdateResult rebaseAndUpdate(QSharedPointer<QObject> object, int rebaseCount, bool deferWriteBack);
     QList<QSharedPointer<QObject> > readObjects(QpDatasourceResult *datasourceResult) const;
     void handleCreatedObjects(const QList<QSharedPointer<QObject> > &objects);
     void handleUpdatedObjects(const QList<QSharedPointer<QObject> > &objects);
+    bool writeBulkDatabaseQueries();
+    void finishBulkDatabaseQueries();
+    void clearBulkDatabaseQueries();
 
     QpReply *makeReply(QpDatasourceResult *result, std::function<void(QpDatasourceResult *, QpReply *)> handleResult) const;
 };
@@ -130,6 +153,12 @@ public:
     {
         return Qp::castList<T>(QpDataAccessObjectBase::readAllObjects(skip, count, condition, orders));
     }
+    QpCursor<T> openCursor(const QpCondition &condition = QpCondition(),
+                           QList<QpDatasource::OrderField> orders = QList<QpDatasource::OrderField>(),
+                           int batchSize = 1000) const
+    {
+        return QpCursor<T>(QpDataAccessObjectBase::openCursor(condition, orders, batchSize));
+    }
 
 protected:
     QpDataAccessObject(QpStorage *parent) :
@@ -27,7 +27,11 @@ const char* QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY("_Qp_ID");
 const char* QpDatabaseSchema::ONDELETE_CASCADE("CASCADE");
 const char* QpDatabaseSchema::COLUMN_NAME_REVISION("_Qp_revision");
 const char* QpDatabaseSchema::COLUMN_NAME_ACTION("_Qp_action");
+const char* QpDatabaseSchema::COLUMN_NAME_VERSION("_Qp_version");
 const char* QpDatabaseSchema::TABLE_NAME_TEMPLATE_HISTORY("%1_Qp_history");
+const char* QpDatabaseSchema::TABLENAME_SEQUENCES("_Qp_sequences");
+const char* QpDatabaseSchema::COLUMN_NAME_SEQUENCE_NAME("name");
+const char* QpDatabaseSchema::COLUMN_NAME_SEQUENCE_VALUE("value");
 #ifndef QP_NO_TIMESTAMPS
 const char* QpDatabaseSchema::COLUMN_NAME_CREATION_TIME("_Qp_creationTime");
 const char* QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME("_Qp_updateTime");
@@ -46,6 +50,95 @@ const char* QpDatabaseSchema::COLUMN_NAME_SCHEMAVERSION_SCRIPT("script");
 const char* QpDatabaseSchema::COLUMN_NAME_SCHEMAVERSION_DATEAPPLIED("date_applied");
 #endif
 
+// MySQL can not put a unique key on a TEXT column without a prefix length
+static const char* SEQUENCE_NAME_COLUMN_TYPE("VARCHAR(255) NOT NULL");
+
+// The materialized revision columns on the main tables
+static const char* REVISION_COLUMN_TYPE("INTEGER NOT NULL DEFAULT 0");
+#ifdef QP_FOR_MYSQL
+static const char* ACTION_COLUMN_TYPE("ENUM('INSERT', 'UPDATE', 'MARK_AS_DELETE', 'DELETE') DEFAULT 'INSERT'");
+#else
+static const char* ACTION_COLUMN_TYPE("TEXT DEFAULT 'INSERT'");
+#endif
+
+static bool execAll(QpSqlQuery &query, const QStringList &statements)
+{
+    foreach (const QString &statement, statements) {
+        if (!query.exec(statement))
+            return false;
+    }
+    return true;
+}
+
+static QStringList historyInsertTriggers(const QString &table, bool materializeRevision)
+{
+    if (!materializeRevision) {
+        return QStringList() << QString::fromLatin1(
+                    "CREATE TRIGGER `%1_Qp_history_INSERT` AFTER INSERT ON `%1` FOR EACH ROW "
+                    "INSERT INTO `%1_Qp_history` VALUES ("
+                    "NULL, "
+                    "NEW.`_Qp_ID`,"
+                    "'INSERT', "
+                    "NOW(6) + 0,"
+                    "CURRENT_USER()"
+                    ");")
+                .arg(table);
+    }
+
+    // Only a BEFORE trigger may change the inserted row, but it does not know its primary key yet.
+    // So the history row is written with the key 0 and the AFTER trigger fills in the key.
+    return QStringList()
+            << QString::fromLatin1(
+                   "CREATE TRIGGER `%1_Qp_history_INSERT` BEFORE INSERT ON `%1` FOR EACH ROW BEGIN "
+                   "INSERT INTO `%1_Qp_history` VALUES ("
+                   "NULL, "
+                   "0,"
+                   "'INSERT', "
+                   "NOW(6) + 0,"
+                   "CURRENT_USER()"
+                   "); "
+                   "SET NEW.`_Qp_revision` = LAST_INSERT_ID(), "
+                   "NEW.`_Qp_action` = 'INSERT'; "
+                   "END")
+               .arg(table)
+            << QString::fromLatin1(
+                   "CREATE TRIGGER `%1_Qp_history_INSERT_ID` AFTER INSERT ON `%1` FOR EACH ROW "
+                   "UPDATE `%1_Qp_history` SET `_Qp_ID` = NEW.`_Qp_ID` "
+                   "WHERE `_Qp_revision` = NEW.`_Qp_revision`;")
+               .arg(table);
+}
+
+static QString historyUpdateTrigger(const QString &table, bool materializeRevision)
+{
+    if (!materializeRevision) {
+        return QString::fromLatin1(
+                    "CREATE TRIGGER `%1_Qp_history_UPDATE` AFTER UPDATE ON `%1` FOR EACH ROW "
+                    "INSERT INTO `%1_Qp_history` VALUES ("
+                    "NULL, "
+                    "NEW.`_Qp_ID`,"
+                    "CASE WHEN NEW.`_Qp_deleted` = 0 THEN 'UPDATE' ELSE 'MARK_AS_DELETE' END, "
+                    "NOW(6) + 0,"
+                    "CURRENT_USER()"
+                    ");")
+                .arg(table);
+    }
+
+    // Only a BEFORE trigger may change the updated row itself
+    return QString::fromLatin1(
+                "CREATE TRIGGER `%1_Qp_history_UPDATE` BEFORE UPDATE ON `%1` FOR EACH ROW BEGIN "
+                "INSERT INTO `%1_Qp_history` VALUES ("
+                "NULL, "
+                "NEW.`_Qp_ID`,"
+                "CASE WHEN NEW.`_Qp_deleted` = 0 THEN 'UPDATE' ELSE 'MARK_AS_DELETE' END, "
+                "NOW(6) + 0,"
+                "CURRENT_USER()"
+                "); "
+                "SET NEW.`_Qp_revision` = LAST_INSERT_ID(), "
+                "NEW.`_Qp_action` = CASE WHEN NEW.`_Qp_deleted` = 0 THEN 'UPDATE' ELSE 'MARK_AS_DELETE' END; "
+                "END")
+            .arg(table);
+}
+
 
 /******************************************************************************
  * QpDatabaseSchemaData
@@ -115,6 +208,8 @@ bool QpDatabaseSchema::dropTable(const QString &table)
         data->storage->setLastError(data->query);
         return false;
     }
+
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -206,6 +301,14 @@ bool QpDatabaseSchema::createTable(const QMetaObject &metaObject)
     data->query.addPrimaryKey(COLUMN_NAME_PRIMARY_KEY);
     data->query.addField(COLUMN_NAME_DELETEDFLAG, "BOOLEAN DEFAULT false");
 
+    if (data->storage->isOptimisticConcurrencyEnabled())
+        data->query.addField(COLUMN_NAME_VERSION, "INTEGER NOT NULL DEFAULT 0");
+
+    if (data->storage->isMaterializedRevisionsEnabled()) {
+        data->query.addField(COLUMN_NAME_REVISION, REVISION_COLUMN_TYPE);
+        data->query.addField(COLUMN_NAME_ACTION, ACTION_COLUMN_TYPE);
+    }
+
 #ifndef QP_NO_TIMESTAMPS
     // Add timestamp columns
     data->query.addField(COLUMN_NAME_CREATION_TIME, variantTypeToSqlType(QVariant::Double));
@@ -230,6 +333,7 @@ bool QpDatabaseSchema::createTable(const QMetaObject &metaObject)
         return false;
     }
 
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -273,6 +377,7 @@ bool QpDatabaseSchema::createManyToManyRelationTables(const QMetaObject &metaObj
         }
     }
 
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -302,6 +407,20 @@ bool QpDatabaseSchema::addMissingColumns(const QMetaObject &metaObject)
             return false;
     }
 
+    if (data->storage->isOptimisticConcurrencyEnabled()
+        && !data->database.record(meta.tableName()).contains(COLUMN_NAME_VERSION)) {
+        if (!addColumn(meta.tableName(), COLUMN_NAME_VERSION, "INTEGER NOT NULL DEFAULT 0"))
+            return false;
+    }
+
+    if (data->storage->isMaterializedRevisionsEnabled()
+        && !data->database.record(meta.tableName()).contains(COLUMN_NAME_REVISION)) {
+        if (!addColumn(meta.tableName(), COLUMN_NAME_REVISION, REVISION_COLUMN_TYPE)
+            || !addColumn(meta.tableName(), COLUMN_NAME_ACTION, ACTION_COLUMN_TYPE)
+            || !materializeRevisions(meta.tableName()))
+            return false;
+    }
+
 #if !defined QP_NO_LOCKS || !defined QP_NO_TIMESTAMPS
     // Check for special columns
     QSqlRecord record = data->database.record(meta.tableName());
@@ -384,11 +503,13 @@ bool QpDatabaseSchema::addColumn(const QString &table, const QString &column, co
         return false;
     }
 
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
 bool QpDatabaseSchema::dropColumns(const QString &table, const QStringList &columns)
 {
+    QpSqlQuery::removeStatementCache(data->database);
     data->database.close();
 
     if (!data->database.open()
@@ -437,8 +558,11 @@ bool QpDatabaseSchema::dropColumns(const QString &table, const QStringList &colu
     if (!data->storage->commitOrRollbackTransaction())
         return false;
 
+    QpSqlQuery::removeStatementCache(data->database);
     data->database.close();
     data->database.open();
+
+    data->storage->databaseSchemaChanged();
     return result;
 }
 
@@ -460,6 +584,9 @@ bool QpDatabaseSchema::enableHistoryTracking(const QMetaObject &metaObject)
 
 bool QpDatabaseSchema::enableHistoryTracking(const QString &table)
 {
+    bool hasRevisionColumns = data->storage->isMaterializedRevisionsEnabled()
+                              && data->database.record(table).contains(COLUMN_NAME_REVISION);
+
     if (!data->storage->beginTransaction()) {
         data->storage->setLastError(QpError(data->database.lastError()));
         return false;
@@ -476,26 +603,8 @@ bool QpDatabaseSchema::enableHistoryTracking(const QString &table)
                             "`user` VARCHAR(100) NOT NULL,"
                             "UNIQUE KEY (`_Qp_ID`, `_Qp_revision`));")
                     .arg(table))
-        || !query.exec(QString::fromLatin1(
-                               "CREATE TRIGGER `%1_Qp_history_INSERT` AFTER INSERT ON `%1` FOR EACH ROW "
-                               "INSERT INTO `%1_Qp_history` VALUES ("
-                               "NULL, "
-                               "NEW.`_Qp_ID`,"
-                               "'INSERT', "
-                               "NOW(6) + 0,"
-                               "CURRENT_USER()"
-                               ");")
-                       .arg(table))
-        || !query.exec(QString::fromLatin1(
-                               "CREATE TRIGGER `%1_Qp_history_UPDATE` AFTER UPDATE ON `%1` FOR EACH ROW "
-                               "INSERT INTO `%1_Qp_history` VALUES ("
-                               "NULL, "
-                               "NEW.`_Qp_ID`,"
-                               "CASE WHEN NEW.`_Qp_deleted` = 0 THEN 'UPDATE' ELSE 'MARK_AS_DELETE' END, "
-                               "NOW(6) + 0,"
-                               "CURRENT_USER()"
-                               ");")
-                       .arg(table))
+        || !execAll(query, historyInsertTriggers(table, hasRevisionColumns))
+        || !query.exec(historyUpdateTrigger(table, hasRevisionColumns))
         || !query.exec(QString::fromLatin1(
                                "CREATE TRIGGER `%1_Qp_history_DELETE` BEFORE DELETE ON `%1` FOR EACH ROW "
                                "INSERT INTO `%1_Qp_history` VALUES ("
@@ -516,6 +625,43 @@ bool QpDatabaseSchema::enableHistoryTracking(const QString &table)
         return false;
     }
 
+    data->storage->databaseSchemaChanged();
+    return true;
+}
+
+bool QpDatabaseSchema::materializeRevisions(const QString &table)
+{
+    // Tables without history are handled by enableHistoryTracking()
+    QString historyTable = QString::fromLatin1(TABLE_NAME_TEMPLATE_HISTORY).arg(table);
+    if (!data->database.tables().contains(historyTable))
+        return true;
+
+    QpSqlQuery query(data->database);
+
+    // The triggers are replaced. The old UPDATE trigger must not record the copying of the latest revisions as an update.
+    if (!query.exec(QString::fromLatin1("DROP TRIGGER IF EXISTS `%1_Qp_history_INSERT`")
+                    .arg(table))
+        || !query.exec(QString::fromLatin1("DROP TRIGGER IF EXISTS `%1_Qp_history_INSERT_ID`")
+                       .arg(table))
+        || !query.exec(QString::fromLatin1("DROP TRIGGER IF EXISTS `%1_Qp_history_UPDATE`")
+                       .arg(table))
+        || !query.exec(QString::fromLatin1(
+                           "UPDATE `%1` SET "
+                           "`_Qp_revision` = COALESCE(("
+                           "SELECT MAX(`history`.`_Qp_revision`) FROM `%1_Qp_history` AS `history` "
+                           "WHERE `history`.`_Qp_ID` = `%1`.`_Qp_ID`), 0), "
+                           "`_Qp_action` = COALESCE(("
+                           "SELECT `history`.`_Qp_action` FROM `%1_Qp_history` AS `history` "
+                           "WHERE `history`.`_Qp_ID` = `%1`.`_Qp_ID` "
+                           "ORDER BY `history`.`_Qp_revision` DESC LIMIT 1), 'INSERT')")
+                       .arg(table))
+        || !execAll(query, historyInsertTriggers(table, true))
+        || !query.exec(historyUpdateTrigger(table, true))) {
+        data->storage->setLastError(query);
+        return false;
+    }
+
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -524,6 +670,7 @@ bool QpDatabaseSchema::cleanSchema()
 #ifdef QP_FOR_SQLITE
     QFile file(data->database.databaseName());
     if (file.exists()) {
+        QpSqlQuery::removeStatementCache(data->database);
         if (!file.remove()) {
             qCritical() << Q_FUNC_INFO << "Could not remove database file"<< file.fileName();
             return false;
@@ -548,6 +695,7 @@ bool QpDatabaseSchema::cleanSchema()
         return false;
     }
 
+    QpSqlQuery::removeStatementCache(data->database);
     data->database.close();
     data->database.open();
 #else
@@ -557,6 +705,7 @@ bool QpDatabaseSchema::cleanSchema()
     }
 #endif
 
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -573,6 +722,7 @@ bool QpDatabaseSchema::createCleanSchema()
 #endif
 
     createSchemaVersioningTable();
+    createSequencesTable();
 
     foreach (const QpMetaObject &metaObject, QpMetaObject::registeredMetaObjects()) {
         createTable(metaObject.metaObject());
@@ -600,6 +750,7 @@ bool QpDatabaseSchema::adjustSchema()
 #ifndef QP_NO_SCHEMAVERSIONING
     createSchemaVersioningTable();
 #endif
+    createSequencesTable();
 
     foreach (const QpMetaObject &metaObject, QpMetaObject::registeredMetaObjects()) {
         createTableIfNotExists(metaObject.metaObject());
@@ -634,6 +785,27 @@ bool QpDatabaseSchema::setForeignKeyChecks(bool check)
     return true;
 }
 
+bool QpDatabaseSchema::createSequencesTable()
+{
+    if (existsTable(QpDatabaseSchema::TABLENAME_SEQUENCES))
+        return true;
+
+    data->query.clear();
+    data->query.setTable(QpDatabaseSchema::TABLENAME_SEQUENCES);
+    data->query.addPrimaryKey(COLUMN_NAME_PRIMARY_KEY);
+    data->query.addField(QpDatabaseSchema::COLUMN_NAME_SEQUENCE_NAME, QString::fromLatin1(SEQUENCE_NAME_COLUMN_TYPE));
+    data->query.addField(QpDatabaseSchema::COLUMN_NAME_SEQUENCE_VALUE, variantTypeToSqlType(QVariant::Int));
+    data->query.addKey(QpSqlBackend::forDatabase(data->database)->uniqueKeyType(),
+                       QStringList() << QpDatabaseSchema::COLUMN_NAME_SEQUENCE_NAME);
+    data->query.prepareCreateTable();
+
+    if (!data->query.exec()) {
+        data->storage->setLastError(data->query);
+        return false;
+    }
+    return true;
+}
+
 #ifndef QP_NO_LOCKS
 bool QpDatabaseSchema::createLocksTable()
 {
@@ -702,6 +874,7 @@ bool QpDatabaseSchema::renameColumn(const QString &tableName, const QString &old
     Q_ASSERT_X(false, Q_FUNC_INFO, "Renaming columns is currently only supported on QP_FOR_SQLITE databases.");
 #endif
 
+    QpSqlQuery::removeStatementCache(data->database);
     data->database.close();
     data->database.open();
 
@@ -741,8 +914,11 @@ bool QpDatabaseSchema::renameColumn(const QString &tableName, const QString &old
     if (!data->storage->commitOrRollbackTransaction())
         return false;
 
+    QpSqlQuery::removeStatementCache(data->database);
     data->database.close();
     data->database.open();
+
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -755,6 +931,7 @@ bool QpDatabaseSchema::renameTable(const QString &oldTableName, const QString &n
         return false;
     }
 
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -787,6 +964,7 @@ bool QpDatabaseSchema::createColumnCopy(const QString &sourceTable,
     if (!data->storage->commitOrRollbackTransaction())
         return false;
 
+    data->storage->databaseSchemaChanged();
     return true;
 }
 
@@ -22,8 +22,12 @@ public:
     static const char* COLUMN_NAME_PRIMARY_KEY;
     static const char* COLUMN_NAME_REVISION;
     static const char* COLUMN_NAME_ACTION;
+    static const char* COLUMN_NAME_VERSION;
     static const char* TABLE_NAME_TEMPLATE_HISTORY;
     static const char* ONDELETE_CASCADE;
+    static const char* TABLENAME_SEQUENCES;
+    static const char* COLUMN_NAME_SEQUENCE_NAME;
+    static const char* COLUMN_NAME_SEQUENCE_VALUE;
 #ifndef QP_NO_TIMESTAMPS
     static const char* COLUMN_NAME_CREATION_TIME;
     static const char* COLUMN_NAME_UPDATE_TIME;
@@ -59,6 +63,7 @@ public:
     bool enableHistoryTracking();
     bool enableHistoryTracking(const QMetaObject &metaObject);
     bool enableHistoryTracking(const QString &table);
+    bool materializeRevisions(const QString &table);
 
     bool cleanSchema();
     bool createCleanSchema();
@@ -67,6 +72,7 @@ public:
     bool setForeignKeyChecks(bool check);
 
     bool createManyToManyRelationTables(const QMetaObject &metaObject);
+    bool createSequencesTable();
 
 #ifndef QP_NO_LOCKS
     bool createLocksTable();
@@ -2,6 +2,10 @@
 
 #include "storage.h"
 
+QpDatasourceCursor::~QpDatasourceCursor()
+{
+}
+
 QpDatasource::QpDatasource(QObject *parent) :
     QObject(parent)
 {
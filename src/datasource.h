@@ -12,6 +12,18 @@ class QpDatasourceResult;
 class QpMetaObject;
 class QpStorage;
 
+/*!
+ * \brief The QpDatasourceCursor class reads the objects of an open statement in batches.
+ */
+class QpDatasourceCursor
+{
+public:
+    virtual ~QpDatasourceCursor();
+
+    //! Adds up to count objects to the result. Less than count objects mean, that the statement has been read completely.
+    virtual void fetch(QpDatasourceResult *result, int count) = 0;
+};
+
 class QpDatasource : public QObject
 {
     Q_OBJECT
@@ -34,22 +46,36 @@ public:
     Q_DECLARE_FLAGS(Features, Feature)
 
     virtual QpDatasource *cloneForThread(QThread *thread) const = 0;
+    //! Drops everything, which has been cached about the tables and columns of the database
+    virtual void clearSchemaCache() = 0;
 
     QpDatasource(QObject *storage = 0);
     ~QpDatasource();
 
     virtual QpDatasource::Features features() const = 0;
     virtual void count(QpDatasourceResult *result, const QpMetaObject &metaObject, const QpCondition &condition) const = 0;
+    virtual void approximateCount(QpDatasourceResult *result, const QpMetaObject &metaObject) const = 0;
     virtual void latestRevision(QpDatasourceResult *result, const QpMetaObject &metaObject) const = 0;
     virtual void maxPrimaryKey(QpDatasourceResult *result, const QpMetaObject &metaObject) const = 0;
     virtual void objectByPrimaryKey(QpDatasourceResult *result, const QpMetaObject &metaObject, int primaryKey) const = 0;
     virtual void objects(QpDatasourceResult *result, const QpMetaObject &metaObject, int skip, int limit, const QpCondition &condition, QList<QpDatasource::OrderField> orders) const = 0;
+    virtual QpDatasourceCursor *openCursor(QpDatasourceResult *result, const QpMetaObject &metaObject, const QpCondition &condition, QList<QpDatasource::OrderField> orders) const = 0;
     virtual void objectsUpdatedAfterRevision(QpDatasourceResult *result, const QpMetaObject &metaObject, int revision) const = 0;
     virtual void objectRevision(QpDatasourceResult *result, const QObject *object) const = 0;
+    //! Reports the revision of each object as a data transfer object, which only has its primary key and its revision.
+    virtual void objectRevisions(QpDatasourceResult *result, const QpMetaObject &metaObject, const QList<int> &primaryKeys) const = 0;
     virtual void insertObject(QpDatasourceResult *result, const QObject *object) const = 0;
+    //! Inserts objects of one class and reports one data transfer object per object in the order of objects.
+    virtual void insertObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const = 0;
     virtual void updateObject(QpDatasourceResult *result, const QObject *object) const = 0;
+    //! Updates objects of one class together. Conflicts of optimistic concurrency are not reported.
+    virtual void updateObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const = 0;
     virtual void removeObject(QpDatasourceResult *result, const QObject *v) const = 0;
+    virtual void removeObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const = 0;
     virtual void incrementNumericColumn(QpDatasourceResult *result, const QObject *object, const QString &fieldName) const = 0;
+    //! Atomically advances the sequence of a column by count and reports the last reserved value as integer result.
+    //! A sequence, which has not been used yet, continues after the largest value in the column.
+    virtual void reserveSequenceValues(QpDatasourceResult *result, const QpMetaObject &metaObject, const QString &fieldName, int count) const = 0;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QpDatasource::Features)
@@ -128,6 +128,15 @@ void QpDatasourceResult::setDataTransferObjects(const QpDataTransferObjectsById
     data->dataTransferObjectsById = dataTransferObjects;
 }
 
+void QpDatasourceResult::setDataTransferObjects(const QpDataTransferObjectList &dataTransferObjects)
+{
+    data->dataTransferObjects = dataTransferObjects;
+    data->dataTransferObjectsById.clear();
+    foreach (const QpDataTransferObject &dataTransferObject, dataTransferObjects) {
+        data->dataTransferObjectsById.insert(dataTransferObject.primaryKey, dataTransferObject);
+    }
+}
+
 void QpDatasourceResult::addDataTransferObject(const QpDataTransferObject &dataTransferObject)
 {
     data->dataTransferObjects << dataTransferObject;
@@ -146,7 +155,8 @@ void QpDatasourceResult::reset()
 }
 
 QpDataTransferObject::QpDataTransferObject() :
-    primaryKey(0)
+    primaryKey(0),
+    writeBackOnly(false)
 {
 }
 
@@ -155,11 +165,21 @@ int QpDataTransferObject::revision() const
     return dynamicProperties.value(QpDatabaseSchema::COLUMN_NAME_REVISION).toInt();
 }
 
+int QpDataTransferObject::version() const
+{
+    return dynamicProperties.value(QpDatabaseSchema::COLUMN_NAME_VERSION).toInt();
+}
+
 bool QpDataTransferObject::isEmpty() const
 {
     return properties.isEmpty() && dynamicProperties.isEmpty() && toOneRelationFKs.isEmpty() && toManyRelationFKs.isEmpty();
 }
 
+bool QpDataTransferObject::hasChanges() const
+{
+    return !isEmpty() || !toManyRelationFKsAdded.isEmpty() || !toManyRelationFKsRemoved.isEmpty();
+}
+
 QpDataTransferObjectDiff QpDataTransferObject::diff(const QObject *object) const
 {
     QpDataTransferObjectDiff result;
@@ -170,7 +190,8 @@ QpDataTransferObjectDiff QpDataTransferObject::diff(const QObject *object) const
         return result;
     }
 
-    if (previousDto.revision() == revision()) {
+    if (previousDto.revision() == revision()
+        && previousDto.version() == version()) {
         result.right = *this;
         return result;
     }
@@ -301,6 +322,21 @@ QpDataTransferObject QpDataTransferObject::merge(const QpDataTransferObject &oth
 
 void QpDataTransferObject::write(QObject *object) const
 {
+    if (writeBackOnly) {
+        foreach (QString propertyName, dynamicProperties.keys()) {
+            object->setProperty(propertyName.toLatin1(), dynamicProperties.value(propertyName));
+        }
+
+        // The object's state has just been written, so it becomes the base for further changes
+        QpDataTransferObject snapshot = QpDataTransferObject::readObject(object);
+        snapshot.dynamicProperties = QpDataTransferObject::fromObject(object).dynamicProperties;
+        foreach (QString propertyName, dynamicProperties.keys()) {
+            snapshot.dynamicProperties.insert(propertyName, dynamicProperties.value(propertyName));
+        }
+        object->setProperty("_Qp_dataTransferObject", QVariant::fromValue<QpDataTransferObject>(snapshot));
+        return;
+    }
+
     foreach (int propertyIndex, properties.keys()) {
         metaObject.property(propertyIndex).write(object, properties.value(propertyIndex));
     }
@@ -328,14 +364,17 @@ QpDataTransferObjectDiff QpDataTransferObject::rebase(QObject *object) const
     QpDataTransferObjectDiff diff = QpDataTransferObject::diff(object);
     if (diff.left.isEmpty()) {
         diff.right.write(object);
-        return diff;
     }
-
-    if (diff.isConflict())
+    else if (diff.isConflict()) {
         return diff;
+    }
+    else {
+        QpDataTransferObject merged = diff.right.merge(diff.left);
+        merged.write(object);
+    }
 
-    QpDataTransferObject merged = diff.right.merge(diff.left);
-    merged.write(object);
+    // The remote state is the new base, against which the local changes are tracked
+    object->setProperty("_Qp_dataTransferObject", QVariant::fromValue<QpDataTransferObject>(*this));
     return diff;
 }
 
@@ -376,6 +415,31 @@ QpDataTransferObject QpDataTransferObject::readObject(const QObject *object)
     return result;
 }
 
+QpDataTransferObject QpDataTransferObject::changesInObject(const QObject *object)
+{
+    QpDataTransferObject previousDto = QpDataTransferObject::fromObject(object);
+    QpDataTransferObject objectDto = QpDataTransferObject::readObject(object);
+
+    // The deleted flag is the only dynamic property, which is written back to the database
+    objectDto.dynamicProperties.clear();
+    QpDataTransferObject result = previousDto.compare(objectDto);
+
+    bool deleted = Qp::Private::isDeleted(object);
+    if (previousDto.dynamicProperties.value(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG).toBool() != deleted)
+        result.dynamicProperties.insert(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, deleted);
+
+    // One-to-one relations without a foreign key in our table are not part of the DTO.
+    // They count as changed, unless they have never been touched (i.e. their foreign key is still unknown).
+    foreach (int propertyIndex, objectDto.toOneRelationFKs.keys()) {
+        if (!previousDto.toOneRelationFKs.contains(propertyIndex)
+            && objectDto.toOneRelationFKs.value(propertyIndex) < 0) {
+            result.toOneRelationFKs.remove(propertyIndex);
+        }
+    }
+
+    return result;
+}
+
 bool QpDataTransferObjectDiff::isEmpty() const
 {
     return left.isEmpty() && right.isEmpty();
@@ -24,9 +24,12 @@ public:
     QHash<int, QList<int>> toManyRelationFKs;
     QHash<int, QList<int>> toManyRelationFKsAdded; //! Only used for comparisons
     QHash<int, QList<int>> toManyRelationFKsRemoved;//! Only used for comparisons
+    bool writeBackOnly; //! true, if this DTO only contains the values, which the database has generated during a write
 
     int revision() const; //! the revision in this dto
+    int version() const; //! the optimistic concurrency version in this dto
     bool isEmpty() const; //! true if properties, dynamicProperties, toOneRelationFKs and toManyRelationFKs are empty
+    bool hasChanges() const; //! true if this DTO, as returned by compare() or changesInObject(), contains any change
 
     QpDataTransferObjectDiff diff(const QObject *object) const; //! compares the changes of this DTO with the changes of the object
     QpDataTransferObject compare(const QpDataTransferObject &other) const; //! Returns a DTO containing all the changes which other has compared to this object
@@ -42,6 +45,7 @@ public:
     QpDataTransferObjectDiff rebase(QObject *object) const;
     static QpDataTransferObject fromObject(const QObject *object); //! The "_Qp_dataTransferObject" dynamic property
     static QpDataTransferObject readObject(const QObject *object); //! Reads all object properties
+    static QpDataTransferObject changesInObject(const QObject *object); //! The changes of the object since its last synchronization
 };
 
 class QpDataTransferObjectDiff
@@ -57,6 +61,7 @@ public:
 };
 
 typedef QHash<int, QpDataTransferObject> QpDataTransferObjectsById;
+typedef QList<QpDataTransferObject> QpDataTransferObjectList;
 
 class QpDatasourceResultData;
 class QpDatasourceResult : public QObject
@@ -81,6 +86,7 @@ public slots:
     void reset();
     void setIntegerResult(int result);
     void setDataTransferObjects(const QpDataTransferObjectsById &dataTransferObjects);
+    void setDataTransferObjects(const QpDataTransferObjectList &dataTransferObjects);
     void addDataTransferObject(const QpDataTransferObject &dataTransferObject);
     void setLastError(const QpError &lastError);
 
@@ -94,5 +100,6 @@ private:
 
 Q_DECLARE_METATYPE(QpDataTransferObject)
 Q_DECLARE_METATYPE(QpDataTransferObjectsById)
+Q_DECLARE_METATYPE(QpDataTransferObjectList)
 
 #endif // QPERSISTENCE_DATASOURCERESULT_H
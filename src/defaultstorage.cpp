@@ -29,6 +29,12 @@ void Qp::addErrorHandler(QpAbstractErrorHandler *handler) {
 void Qp::clearErrorHandlers() {
     Qp::defaultStorage()->clearErrorHandlers();
 }
+void Qp::enableOptimisticConcurrency() {
+    Qp::defaultStorage()->enableOptimisticConcurrency();
+}
+void Qp::enableMaterializedRevisions() {
+    Qp::defaultStorage()->enableMaterializedRevisions();
+}
 
 #ifndef QP_NO_LOCKS
 bool Qp::unlockAllLocks() {
@@ -14,6 +14,8 @@ bool createCleanSchema();
 QpError lastError();
 void addErrorHandler(QpAbstractErrorHandler *handler);
 void clearErrorHandlers();
+void enableOptimisticConcurrency();
+void enableMaterializedRevisions();
 #ifndef QP_NO_LOCKS
 void enableLocks();
 bool unlockAllLocks();
@@ -40,12 +42,27 @@ template<class T> QSharedPointer<T> read(int id) {
 template<class T> QList<QSharedPointer<T> > readAll(const QpCondition &condition = QpCondition()) {
     return Qp::defaultStorage()->readAll<T>(condition);
 }
+template<class T> QList<QSharedPointer<T> > readAll(const QpCondition &condition, const QStringList &prefetchRelations) {
+    return Qp::defaultStorage()->readAll<T>(condition, prefetchRelations);
+}
+template<class T> QList<QSharedPointer<QObject> > resolveRelation(const QList<QSharedPointer<T> > &objects, const QString &relationName) {
+    return Qp::defaultStorage()->resolveRelation(objects, relationName);
+}
+template<class T> QList<QSharedPointer<QObject> > prefetch(const QList<QSharedPointer<T> > &objects, const QString &relationPath) {
+    return Qp::defaultStorage()->prefetch(objects, relationPath);
+}
+template<class T> QpCursor<T> openCursor(const QpCondition &condition = QpCondition(), int batchSize = 1000) {
+    return Qp::defaultStorage()->openCursor<T>(condition, batchSize);
+}
 template<class T> int count(const QpCondition &condition = QpCondition()) {
     return Qp::defaultStorage()->count<T>(condition);
 }
 template<class T> QSharedPointer<T> create() {
     return Qp::defaultStorage()->create<T>();
 }
+template<class T> QList<QSharedPointer<T> > createObjects(int count) {
+    return Qp::defaultStorage()->createObjects<T>(count);
+}
 template<class T> UpdateResult update(QSharedPointer<T> object) {
     return Qp::defaultStorage()->update(object);
 }
@@ -67,6 +84,9 @@ template<class T> SynchronizeResult synchronize(QSharedPointer<T> object, QpData
 template<class T> bool incrementNumericColumn(QSharedPointer<T> object, const QString &fieldName) {
     return Qp::defaultStorage()->incrementNumericColumn(object, fieldName);
 }
+template<class T> int nextValue(const QString &fieldName, bool *ok = nullptr) {
+    return Qp::defaultStorage()->nextValue<T>(fieldName, ok);
+}
 #ifndef QP_NO_TIMESTAMPS
 template<class T> QList<QSharedPointer<T> > createdSince(const QDateTime &time) {
     return Qp::defaultStorage()->createdSince<T>(time);
@@ -18,29 +18,85 @@
 class QpLegacySqlDatasourceData : public QSharedData
 {
 public:
-    QSqlDatabase database;
+    QpLegacySqlDatasourceData() :
+        QSharedData(),
+        readBackAfterWrite(false),
+        ownsDatabase(false),
+        autoIncrementLockMode(-1),
+        autoIncrementIncrement(1)
+    {
+    }
+
+    // The SQL for the standard statements of a class, which is generated only once
+    struct Statements {
+        // SELECT ... FROM ... JOIN without any WHERE clause
+        QString selectClause;
+        // binds the primary key
+        QString selectByPrimaryKey;
+        // binds the simple properties
+        QString insert;
+        // binds the simple properties, the deleted flag and the primary key
+        QString updateAll;
+        // binds the primary key
+        QString remove;
+    };
 
+    QSqlDatabase database;
+    bool readBackAfterWrite;
+    bool ownsDatabase; //! true, if the connection has been cloned for the thread of this datasource
+    mutable int autoIncrementLockMode; //! innodb_autoinc_lock_mode of the connection or -1, if it has not been read yet
+    mutable int autoIncrementIncrement; //! auto_increment_increment of the connection, i.e. the distance between two generated keys
+    mutable QHash<QString, QSqlRecord> tableRecords;
+    mutable QHash<QString, Statements> statements;
+
+    bool hasColumn(const QpMetaObject &metaObject, const char *column) const;
+    int maximumInListSize() const;
+    bool hasConsecutiveInsertKeys() const;
+    Statements statementsFor(const QpMetaObject &metaObject) const;
     void selectFields(const QpMetaObject &metaObject, QpSqlQuery &query) const;
+    void selectHistoryRevision(const QpMetaObject &metaObject, QpSqlQuery &query) const;
+    QpDataTransferObject readRow(const QpSqlQuery &query,
+                                 const QSqlRecord &record,
+                                 const QpMetaObject &metaObject) const;
     QHash<int, QpDataTransferObject> readQuery(QpSqlQuery &query,
                                                const QSqlRecord &record,
-                                               const QpMetaObject &metaObject) const;
-    void fillValuesIntoQuery(const QObject *object, QpSqlQuery &query) const;
+                                               const QpMetaObject &metaObject,
+                                               QList<int> *primaryKeysInOrder = nullptr) const;
+    QVariant sqlValue(const QpMetaProperty &property, const QObject *object) const;
+    void fillValuesIntoQuery(const QObject *object, QpSqlQuery &query, const QpDataTransferObject *changes = 0) const;
+    QHash<QString, QVariant> insertRow(const QObject *object) const;
     int objectRevision(const QObject *object, QpError &error) const;
-    void adjustRelationsInDatabase(const QObject *object, QpError &error) const;
+    QHash<int, QpDataTransferObject> objectRevisions(const QpMetaObject &metaObject, const QList<int> &primaryKeys, QpError &error) const;
+    QHash<int, QpDataTransferObject> readWriteBack(const QpMetaObject &metaObject, const QList<int> &primaryKeys, QpError &error) const;
+    int advanceSequence(const QpMetaObject &metaObject, const QString &fieldName, int count, QpError &error) const;
+    QpSqlQuery updateQuery(const QObject *object, QList<QpMetaProperty> &relations) const;
+    void adjustRelationsInDatabase(const QObject *object, const QList<QpMetaProperty> &relations, QpError &error) const;
+    QList<QpMetaProperty> changedRelations(const QpMetaObject &metaObject, const QpDataTransferObject &changes) const;
 
     void readToManyRelations(QHash<int, QpDataTransferObject> &dataTransferObjects,
                              const QpMetaObject &metaObject,
                              const QpCondition &condition,
                              QpError &error) const;
 
+    QHash<int, QpDataTransferObject> readObject(const QpMetaObject &metaObject,
+                                                int primaryKey,
+                                                QpError &error) const;
+    QpSqlQuery selectQuery(const QpMetaObject &metaObject,
+                           int skip,
+                           int limit,
+                           const QpCondition &condition,
+                           QList<QpDatasource::OrderField> orders) const;
     QHash<int, QpDataTransferObject> readObjects(const QpMetaObject &metaObject,
                                                  int skip,
                                                  int limit,
                                                  const QpCondition &condition,
                                                  QList<QpDatasource::OrderField> orders,
-                                                 QpError &error) const;
+                                                 QpError &error,
+                                                 QList<int> *primaryKeysInOrder = nullptr) const;
 
 private:
+    bool relatedKeysChanges(const QpMetaProperty &relation, const QObject *object, QList<int> &added, QList<int> &removed) const;
+    QList<QpCondition> keysConditions(const QString &field, const QList<int> &keys) const;
     QList<QpSqlQuery> queriesThatAdjustOneToOneRelation(const QpMetaProperty &relation, const QObject *object, QpError &error) const;
     QList<QpSqlQuery> queriesThatAdjustOneToManyRelation(const QpMetaProperty &relation, const QObject *object, QpError &error) const;
     QList<QpSqlQuery> queriesThatAdjustToOneRelation(const QpMetaProperty &relation, const QObject *object, QpError &error) const;
@@ -52,6 +108,123 @@ private:
                             QpError &error) const;
 };
 
+bool QpLegacySqlDatasourceData::hasColumn(const QpMetaObject &metaObject, const char *column) const
+{
+    QString table = metaObject.tableName();
+    auto it = tableRecords.find(table);
+    if (it != tableRecords.end())
+        return it.value().contains(column);
+
+    // Do not remember anything about tables, which do not exist (yet)
+    QSqlRecord record = database.record(table);
+    if (record.isEmpty())
+        return false;
+
+    tableRecords.insert(table, record);
+    return record.contains(column);
+}
+
+int QpLegacySqlDatasourceData::maximumInListSize() const
+{
+    // Leaves the other half of the placeholders to the rest of the statement
+    return qMax(1, QpSqlBackend::forDatabase(database)->maximumBindValueCount() / 2);
+}
+
+/*!
+ * Returns true, if the rows of a multi-row INSERT get consecutive keys in the
+ * order of the rows, i.e. keys, which are autoIncrementIncrement apart.
+ */
+bool QpLegacySqlDatasourceData::hasConsecutiveInsertKeys() const
+{
+#ifdef QP_FOR_MYSQL
+    if (autoIncrementLockMode < 0) {
+        QpSqlQuery query(database);
+        if (query.exec(QLatin1String("SELECT @@innodb_autoinc_lock_mode, @@auto_increment_increment")) && query.first()) {
+            autoIncrementLockMode = query.value(0).toInt();
+            autoIncrementIncrement = qMax(1, query.value(1).toInt());
+        }
+        else {
+            autoIncrementLockMode = 2;
+        }
+
+        if (autoIncrementLockMode != 0 && autoIncrementLockMode != 1) {
+            qWarning("The innodb_autoinc_lock_mode of the connection %s is %d. "
+                     "The keys of a multi-row INSERT are not consecutive in this mode, "
+                     "so that many objects are inserted with one INSERT per object. "
+                     "Set innodb_autoinc_lock_mode to 0 or 1 to insert them at once.",
+                     qPrintable(database.connectionName()),
+                     autoIncrementLockMode);
+        }
+    }
+
+    // The "traditional" and the "consecutive" lock modes reserve the keys of a simple
+    // INSERT at once. The "interleaved" mode, which is the default since MySQL 8, does not.
+    return autoIncrementLockMode == 0 || autoIncrementLockMode == 1;
+#else
+    // SQLite has only one writer, which holds the lock until the end of the transaction
+    return true;
+#endif
+}
+
+QpLegacySqlDatasourceData::Statements QpLegacySqlDatasourceData::statementsFor(const QpMetaObject &metaObject) const
+{
+    QString table = metaObject.tableName();
+    auto it = statements.find(table);
+    if (it != statements.end())
+        return it.value();
+
+    bool versionColumn = hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_VERSION);
+    QString now = QpSqlBackend::forDatabase(database)->nowTimestamp();
+    QpCondition primaryKeyCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
+                                    QpCondition::EqualTo,
+                                    0);
+    Statements result;
+
+    QpSqlQuery select(database);
+    select.setTable(table);
+    selectFields(metaObject, select);
+    result.selectClause = select.selectClause();
+    select.setWhereCondition(primaryKeyCondition);
+    result.selectByPrimaryKey = select.selectStatement();
+
+    QpSqlQuery insert(database);
+    insert.setTable(table);
+    foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+        insert.addField(property.columnName());
+    }
+#ifndef QP_NO_TIMESTAMPS
+    insert.addRawField(QpDatabaseSchema::COLUMN_NAME_CREATION_TIME, now);
+#endif
+    result.insert = insert.insertStatement();
+
+    QpSqlQuery update(database);
+    update.setTable(table);
+    foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+        update.addField(property.columnName());
+    }
+    update.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG);
+    if (versionColumn) {
+        update.addRawField(QpDatabaseSchema::COLUMN_NAME_VERSION,
+                           QString::fromLatin1("%1 + 1").arg(QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_VERSION)));
+    }
+#ifndef QP_NO_TIMESTAMPS
+    update.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, now);
+#endif
+    update.setWhereCondition(primaryKeyCondition);
+    result.updateAll = update.updateStatement();
+
+    QpSqlQuery remove(database);
+    remove.setTable(table);
+    remove.setWhereCondition(primaryKeyCondition);
+    result.remove = remove.deleteStatement();
+
+    // Do not remember the statements of tables, which do not exist (yet)
+    if (tableRecords.contains(table))
+        statements.insert(table, result);
+
+    return result;
+}
+
 void QpLegacySqlDatasourceData::selectFields(const QpMetaObject &metaObject, QpSqlQuery &query) const
 {
     query.setForwardOnly(true);
@@ -72,6 +245,8 @@ void QpLegacySqlDatasourceData::selectFields(const QpMetaObject &metaObject, QpS
     // Select some internal fields
     query.addField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY);
     query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG);
+    if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_VERSION))
+        query.addField(QpDatabaseSchema::COLUMN_NAME_VERSION);
 
 #ifndef QP_NO_TIMESTAMPS
     query.addField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME);
@@ -83,8 +258,32 @@ void QpLegacySqlDatasourceData::selectFields(const QpMetaObject &metaObject, QpS
     query.addField(QpDatabaseSchema::COLUMN_LOCK);
 #endif
 
-    // History subselects:
+    // Materialized revisions are maintained on the rows themselves by the history triggers
+    if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_REVISION))
+        query.addField(QpDatabaseSchema::COLUMN_NAME_REVISION);
+    else
+        selectHistoryRevision(metaObject, query);
 
+    // Implicitly join to-one related tables
+    int tableJoin = 0;
+    foreach (const QpMetaProperty relation, metaObject.relationProperties()) {
+        if (relation.hasTableForeignKey()) {
+            query.addField(relation.columnName());
+        }
+        else if (relation.isToOneRelationProperty()) {
+            QString joinName = QString("join_table_%1").arg(tableJoin++);
+            query.addRawField(joinName + "." +
+                              QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY +
+                              " AS  _Qp_FK_" + relation.name());
+            query.addJoin("LEFT", QpSqlQuery::escapeField(relation.tableName()).append(" AS ").append(joinName),
+                          joinName + "." + QpSqlQuery::escapeField(relation.columnName()) +
+                          " = " + query.escapedQualifiedField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY));
+        }
+    }
+}
+
+void QpLegacySqlDatasourceData::selectHistoryRevision(const QpMetaObject &metaObject, QpSqlQuery &query) const
+{
     // We select the revision as a subquery with another subquery, because the needed GROUP BY does not work well with the relations' LEFT JOINs
     // and we also need the `action`-field as a 'content' field as in http://stackoverflow.com/a/7745635.
     // BTW: Other RDBMS wouldn't have allowed this error ;)
@@ -141,117 +340,144 @@ void QpLegacySqlDatasourceData::selectFields(const QpMetaObject &metaObject, QpS
                   .arg(revisionSubQueryName)
                   .arg(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY));
     query.addRawField(QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_REVISION));
-
-    // Implicitly join to-one related tables
-    int tableJoin = 0;
-    foreach (const QpMetaProperty relation, metaObject.relationProperties()) {
-        if (relation.hasTableForeignKey()) {
-            query.addField(relation.columnName());
-        }
-        else if (relation.isToOneRelationProperty()) {
-            QString joinName = QString("join_table_%1").arg(tableJoin++);
-            query.addRawField(joinName + "." +
-                              QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY +
-                              " AS  _Qp_FK_" + relation.name());
-            query.addJoin("LEFT", QpSqlQuery::escapeField(relation.tableName()).append(" AS ").append(joinName),
-                          joinName + "." + QpSqlQuery::escapeField(relation.columnName()) +
-                          " = " + query.escapedQualifiedField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY));
-        }
-    }
 }
 
 
-QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readQuery(QpSqlQuery &query,
-                                                                      const QSqlRecord &record,
-                                                                      const QpMetaObject &metaObject) const
+QpDataTransferObject QpLegacySqlDatasourceData::readRow(const QpSqlQuery &query,
+                                                        const QSqlRecord &record,
+                                                        const QpMetaObject &metaObject) const
 {
-    QHash<int, QpDataTransferObject> result;
-    result.reserve(query.size());
-    while (query.next()) {
-        QpDataTransferObject dto;
-        dto.metaObject = metaObject.metaObject();
-        int fieldCount = record.count();
+    QpDataTransferObject dto;
+    dto.metaObject = metaObject.metaObject();
+    int fieldCount = record.count();
 
-        for (int i = 0; i < fieldCount; ++i) {
-            QString name = record.fieldName(i);
-            QMetaProperty metaProperty = query.propertyForIndex(record, &dto.metaObject, i);
+    for (int i = 0; i < fieldCount; ++i) {
+        QString name = record.fieldName(i);
+        QMetaProperty metaProperty = query.propertyForIndex(record, &dto.metaObject, i);
 
-            if (!metaProperty.isValid()) {
+        if (!metaProperty.isValid()) {
 
-                // To-one relations
-                if (name.startsWith("_Qp_FK")) {
-                    QString propertyName = name.right(name.length() - 7); // remove _Qp_FK_
-                    int propertyIndex = dto.metaObject.indexOfProperty(propertyName.toLatin1());
-                    dto.toOneRelationFKs.insert(propertyIndex, query.value(i).toInt());
-                }
+            // To-one relations
+            if (name.startsWith("_Qp_FK")) {
+                QString propertyName = name.right(name.length() - 7); // remove _Qp_FK_
+                int propertyIndex = dto.metaObject.indexOfProperty(propertyName.toLatin1());
+                dto.toOneRelationFKs.insert(propertyIndex, query.value(i).toInt());
+            }
 
-                // dynamic properties including the primary key
-                else if (name.startsWith("_Qp_")) { // ignore all columns, which do not start with _Qp_
-                    QVariant value = query.value(i);
-                    dto.dynamicProperties.insert(name, value);
+            // dynamic properties including the primary key
+            else if (name.startsWith("_Qp_")) { // ignore all columns, which do not start with _Qp_
+                QVariant value = query.value(i);
+                dto.dynamicProperties.insert(name, value);
 
-                    if (name == QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY)
-                        dto.primaryKey = value.toInt();
-                }
+                if (name == QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY)
+                    dto.primaryKey = value.toInt();
             }
+        }
 
-            // Properties
-            else {
-                int propertyIndex = metaProperty.propertyIndex();
-                QVariant value = query.value(i);
+        // Properties
+        else {
+            int propertyIndex = metaProperty.propertyIndex();
+            QVariant value = query.value(i);
 
-                if (metaProperty.isFlagType()) {
-                    value = value.toInt();
-                } else if (metaProperty.isEnumType()) {
-                    value = metaProperty.enumerator().value(value.toInt());
-                } else {
-                    QMetaType::Type type = static_cast<QMetaType::Type>(metaProperty.userType());
-                    value = QpSqlQuery::variantFromSqlStorableVariant(value, type);
-                }
-                dto.properties.insert(propertyIndex, value);
+            if (metaProperty.isFlagType()) {
+                value = value.toInt();
+            } else if (metaProperty.isEnumType()) {
+                value = metaProperty.enumerator().value(value.toInt());
+            } else {
+                QMetaType::Type type = static_cast<QMetaType::Type>(metaProperty.userType());
+                value = QpSqlQuery::variantFromSqlStorableVariant(value, type);
             }
+            dto.properties.insert(propertyIndex, value);
         }
+    }
+    return dto;
+}
+
+QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readQuery(QpSqlQuery &query,
+                                                                      const QSqlRecord &record,
+                                                                      const QpMetaObject &metaObject,
+                                                                      QList<int> *primaryKeysInOrder) const
+{
+    QHash<int, QpDataTransferObject> result;
+    result.reserve(query.size());
+    while (query.next()) {
+        QpDataTransferObject dto = readRow(query, record, metaObject);
+        if (primaryKeysInOrder && !result.contains(dto.primaryKey))
+            primaryKeysInOrder->append(dto.primaryKey);
         result.insert(dto.primaryKey, dto);
     }
 
     return result;
 }
 
-void QpLegacySqlDatasourceData::fillValuesIntoQuery(const QObject *object,
-                                                    QpSqlQuery &query) const
+QVariant QpLegacySqlDatasourceData::sqlValue(const QpMetaProperty &property, const QObject *object) const
 {
-    QpMetaObject metaObject = QpMetaObject::forObject(object);
+    QVariant value = property.metaProperty().read(object);
 
-    foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
-        QVariant value = property.metaProperty().read(object);
+    // handle NULL SET or ENUM values
+    if (value == QVariant(0)
+        && (property.metaProperty().isEnumType()
+            || property.metaProperty().isFlagType())) {
+        return QVariant();
+    }
 
-        // handle NULL SET or ENUM values
-        if (value == QVariant(0)
-            && (property.metaProperty().isEnumType()
-                || property.metaProperty().isFlagType())) {
-            query.addRawField(property.columnName(), "NULL");
-        }
-        else {
-            // Handle ENUMs
-            if (property.metaProperty().isEnumType() && !property.metaProperty().isFlagType())
+    // Handle ENUMs
+    if (property.metaProperty().isEnumType() && !property.metaProperty().isFlagType())
 #ifdef QP_FOR_MYSQL
-                value = property.metaProperty().enumerator().valueToKey(value.toInt());
+        value = property.metaProperty().enumerator().valueToKey(value.toInt());
 #elif QP_FOR_SQLITE
-                value = value.toInt();
+        value = value.toInt();
 #endif
 
+    return value;
+}
+
+void QpLegacySqlDatasourceData::fillValuesIntoQuery(const QObject *object,
+                                                    QpSqlQuery &query,
+                                                    const QpDataTransferObject *changes) const
+{
+    QpMetaObject metaObject = QpMetaObject::forObject(object);
+
+    foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+        // Only write the changed columns, if we know the changes
+        if (changes && !changes->properties.contains(property.metaProperty().propertyIndex()))
+            continue;
+
+        QVariant value = sqlValue(property, object);
+
+        if (!value.isValid())
+            query.addRawField(property.columnName(), "NULL");
+        else
             query.addField(property.columnName(), value);
-        }
     }
 }
 
+QHash<QString, QVariant> QpLegacySqlDatasourceData::insertRow(const QObject *object) const
+{
+    QpMetaObject metaObject = QpMetaObject::forObject(object);
+
+    // NULL values are bound as invalid variants, so that all rows have the same columns
+    QHash<QString, QVariant> row;
+    foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+        row.insert(property.columnName(), sqlValue(property, object));
+    }
+    return row;
+}
+
 int QpLegacySqlDatasourceData::objectRevision(const QObject *object, QpError &error) const
 {
+    QpMetaObject metaObject = QpMetaObject::forObject(object);
     QpSqlQuery query(database);
-    QString historyTable = QString::fromLatin1(QpDatabaseSchema::TABLE_NAME_TEMPLATE_HISTORY).arg(QpMetaObject::forObject(object).tableName());
-    query.setTable(historyTable);
+    if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_REVISION)) {
+        query.setTable(metaObject.tableName());
+        query.addField(QpDatabaseSchema::COLUMN_NAME_REVISION);
+    }
+    else {
+        QString historyTable = QString::fromLatin1(QpDatabaseSchema::TABLE_NAME_TEMPLATE_HISTORY).arg(metaObject.tableName());
+        query.setTable(historyTable);
+        query.addRawField(QString::fromLatin1("MAX(%1) AS %1").arg(QpDatabaseSchema::COLUMN_NAME_REVISION));
+    }
     query.setLimit(1);
-    query.addRawField(QString::fromLatin1("MAX(%1) AS %1").arg(QpDatabaseSchema::COLUMN_NAME_REVISION));
     query.setWhereCondition(QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
                                         QpCondition::EqualTo,
                                         Qp::Private::primaryKey(object)));
@@ -265,12 +491,195 @@ int QpLegacySqlDatasourceData::objectRevision(const QObject *object, QpError &er
     return query.value(0).toInt();
 }
 
-void QpLegacySqlDatasourceData::adjustRelationsInDatabase(const QObject *object, QpError &error) const
+QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::objectRevisions(const QpMetaObject &metaObject,
+                                                                            const QList<int> &primaryKeys,
+                                                                            QpError &error) const
+{
+    QHash<int, QpDataTransferObject> result;
+    if (primaryKeys.isEmpty())
+        return result;
+
+    // SELECT _Qp_ID, _Qp_revision FROM object WHERE _Qp_ID IN (primaryKeys)
+    // or without materialized revisions:
+    // SELECT _Qp_ID, MAX(_Qp_revision) FROM object_Qp_history WHERE _Qp_ID IN (primaryKeys) GROUP BY _Qp_ID
+    QpSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.addField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY);
+    if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_REVISION)) {
+        query.setTable(metaObject.tableName());
+        query.addField(QpDatabaseSchema::COLUMN_NAME_REVISION);
+    }
+    else {
+        query.setTable(QString::fromLatin1(QpDatabaseSchema::TABLE_NAME_TEMPLATE_HISTORY).arg(metaObject.tableName()));
+        query.addRawField(QString::fromLatin1("MAX(%1) AS %1").arg(QpDatabaseSchema::COLUMN_NAME_REVISION));
+        query.addGroupBy(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY);
+    }
+
+    foreach (const QpCondition &keys, QpCondition::primaryKeys(primaryKeys).splitInLists(maximumInListSize())) {
+        query.setWhereCondition(keys);
+        query.prepareSelect();
+
+        if (!query.exec()) {
+            error = QpError(query);
+            return QHash<int, QpDataTransferObject>();
+        }
+
+        while (query.next()) {
+            QpDataTransferObject dto;
+            dto.metaObject = metaObject.metaObject();
+            dto.primaryKey = query.value(0).toInt();
+            dto.dynamicProperties.insert(QpDatabaseSchema::COLUMN_NAME_REVISION, query.value(1).toInt());
+            result.insert(dto.primaryKey, dto);
+        }
+    }
+
+    return result;
+}
+
+QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readWriteBack(const QpMetaObject &metaObject,
+                                                                          const QList<int> &primaryKeys,
+                                                                          QpError &error) const
+{
+    QHash<int, QpDataTransferObject> result;
+    if (primaryKeys.isEmpty())
+        return result;
+
+    // SELECT _Qp_ID, _Qp_deleted, ..., (SELECT MAX(_Qp_revision) FROM object_Qp_history WHERE ...) AS _Qp_revision
+    // FROM object WHERE _Qp_ID IN (primaryKeys)
+    const QString historyTable = QString::fromLatin1(QpDatabaseSchema::TABLE_NAME_TEMPLATE_HISTORY).arg(metaObject.tableName());
+
+    QpSqlQuery query(database);
+    query.setTable(metaObject.tableName());
+    query.setForwardOnly(true);
+    query.addField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY);
+    query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG);
+    if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_VERSION))
+        query.addField(QpDatabaseSchema::COLUMN_NAME_VERSION);
+#ifndef QP_NO_TIMESTAMPS
+    query.addField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME);
+    query.addField(QpDatabaseSchema::COLUMN_NAME_CREATION_TIME);
+#endif
+    if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_REVISION)) {
+        query.addField(QpDatabaseSchema::COLUMN_NAME_REVISION);
+    }
+    else {
+        query.addRawField(QString::fromLatin1("(SELECT MAX(%1) FROM %2 WHERE %2.%3 = %4) AS %1")
+                          .arg(QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_REVISION))
+                          .arg(QpSqlQuery::escapeField(historyTable))
+                          .arg(QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY))
+                          .arg(query.escapedQualifiedField(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY)));
+    }
+
+    foreach (const QpCondition &keys, QpCondition::primaryKeys(primaryKeys).splitInLists(maximumInListSize())) {
+        query.setWhereCondition(keys);
+        query.prepareSelect();
+
+        if (!query.exec()) {
+            error = QpError(query);
+            return QHash<int, QpDataTransferObject>();
+        }
+
+        QSqlRecord record = query.record();
+        while (query.next()) {
+            QpDataTransferObject dto;
+            dto.metaObject = metaObject.metaObject();
+            dto.primaryKey = query.value(0).toInt();
+            dto.writeBackOnly = true;
+
+            for (int i = 0; i < record.count(); ++i) {
+                dto.dynamicProperties.insert(record.fieldName(i), query.value(i));
+            }
+            result.insert(dto.primaryKey, dto);
+        }
+    }
+
+    return result;
+}
+
+int QpLegacySqlDatasourceData::advanceSequence(const QpMetaObject &metaObject,
+                                               const QString &fieldName,
+                                               int count,
+                                               QpError &error) const
+{
+    const QString sequence = QString::fromLatin1("%1.%2").arg(metaObject.tableName()).arg(fieldName);
+    const QString sequencesTable = QpSqlQuery::escapeField(QpDatabaseSchema::TABLENAME_SEQUENCES);
+    const QString nameColumn = QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_SEQUENCE_NAME);
+    const QString valueColumn = QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_SEQUENCE_VALUE);
+
+#ifdef QP_FOR_MYSQL
+    // LAST_INSERT_ID(expr) remembers the new value for this connection, so that we need no transaction to read it
+    const QString increment = QString::fromLatin1("LAST_INSERT_ID(%1 + ?)").arg(valueColumn);
+#else
+    const QString increment = QString::fromLatin1("%1 + ?").arg(valueColumn);
+#endif
+
+    // UPDATE _Qp_sequences SET value = value + count WHERE name = 'table.field'
+    QpSqlQuery query(database);
+    for (int tryCount = 0; tryCount < 2; ++tryCount) {
+        query.prepare(QString::fromLatin1("UPDATE %1 SET %2 = %3 WHERE %4 = ?")
+                      .arg(sequencesTable)
+                      .arg(valueColumn)
+                      .arg(increment)
+                      .arg(nameColumn));
+        query.addBindValue(count);
+        query.addBindValue(sequence);
+
+        if (!query.exec()) {
+            error = QpError(query);
+            return -1;
+        }
+
+        if (query.numRowsAffected() > 0)
+            break;
+
+        if (tryCount > 0) {
+            error = QpError(QString::fromLatin1("The sequence %1 could not be created.").arg(sequence),
+                            QpError::SqlError);
+            return -1;
+        }
+
+        // The first use of a sequence continues after the largest value in the column.
+        // Somebody else might create it at the same time, in which case the row is ignored.
+        query.prepare(QString::fromLatin1("INSERT %1 INTO %2 (%3, %4) SELECT ?, COALESCE(MAX(%5), 0) FROM %6")
+                      .arg(QpSqlBackend::forDatabase(database)->orIgnore())
+                      .arg(sequencesTable)
+                      .arg(nameColumn)
+                      .arg(valueColumn)
+                      .arg(QpSqlQuery::escapeField(fieldName))
+                      .arg(QpSqlQuery::escapeField(metaObject.tableName())));
+        query.addBindValue(sequence);
+
+        if (!query.exec()) {
+            error = QpError(query);
+            return -1;
+        }
+    }
+
+#ifdef QP_FOR_MYSQL
+    query.prepare(QLatin1String("SELECT LAST_INSERT_ID()"));
+#else
+    query.prepare(QString::fromLatin1("SELECT %1 FROM %2 WHERE %3 = ?")
+                  .arg(valueColumn)
+                  .arg(sequencesTable)
+                  .arg(nameColumn));
+    query.addBindValue(sequence);
+#endif
+
+    if (!query.exec() || !query.first()) {
+        error = QpError(query);
+        return -1;
+    }
+
+    return query.value(0).toInt();
+}
+
+void QpLegacySqlDatasourceData::adjustRelationsInDatabase(const QObject *object,
+                                                          const QList<QpMetaProperty> &relations,
+                                                          QpError &error) const
 {
     QList<QpSqlQuery> queries;
-    QpMetaObject metaObject = QpMetaObject::forObject(object);
 
-    foreach (const QpMetaProperty property, metaObject.relationProperties()) {
+    foreach (const QpMetaProperty property, relations) {
         QpMetaProperty::Cardinality cardinality = property.cardinality();
 
         if (cardinality == QpMetaProperty::OneToOneCardinality) {
@@ -298,6 +707,108 @@ void QpLegacySqlDatasourceData::adjustRelationsInDatabase(const QObject *object,
     }
 }
 
+QpSqlQuery QpLegacySqlDatasourceData::updateQuery(const QObject *object, QList<QpMetaProperty> &relations) const
+{
+    QpMetaObject metaObject = QpMetaObject::forObject(object);
+    int primaryKey = Qp::Private::primaryKey(object);
+
+    QpDataTransferObject snapshot = QpDataTransferObject::fromObject(object);
+    QpSqlQuery query(database);
+    relations = metaObject.relationProperties();
+
+    QVariant version = snapshot.dynamicProperties.value(QpDatabaseSchema::COLUMN_NAME_VERSION);
+
+    // Objects, which have never been read from the database, write all columns with the generated UPDATE
+    if (snapshot.isEmpty() && !version.isValid()) {
+        query.prepareStatement(statementsFor(metaObject).updateAll);
+        foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+            query.addBindValue(sqlValue(property, object));
+        }
+        query.addBindValue(Qp::Private::isDeleted(object));
+        query.addBindValue(primaryKey);
+    }
+
+    // Otherwise the UPDATE is generated for the version and, if known, the changed columns only
+    else {
+        query.setTable(metaObject.tableName());
+        QpCondition whereCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
+                                   QpCondition::EqualTo,
+                                   primaryKey);
+        if (version.isValid()) {
+            whereCondition = whereCondition && QpCondition(QpDatabaseSchema::COLUMN_NAME_VERSION,
+                                                           QpCondition::EqualTo,
+                                                           version);
+        }
+        query.setWhereCondition(whereCondition);
+
+        if (snapshot.isEmpty()) {
+            fillValuesIntoQuery(object, query);
+            query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, Qp::Private::isDeleted(object));
+        }
+        else {
+            QpDataTransferObject changes = QpDataTransferObject::changesInObject(object);
+            fillValuesIntoQuery(object, query, &changes);
+            if (changes.dynamicProperties.contains(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG))
+                query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, Qp::Private::isDeleted(object));
+            relations = changedRelations(metaObject, changes);
+        }
+
+        if (hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_VERSION)) {
+            query.addRawField(QpDatabaseSchema::COLUMN_NAME_VERSION,
+                              QString::fromLatin1("%1 + 1").arg(QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_VERSION)));
+        }
+#ifndef QP_NO_TIMESTAMPS
+        query.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, QpSqlBackend::forDatabase(database)->nowTimestamp());
+#endif
+        query.prepareUpdate();
+    }
+
+    return query;
+}
+
+QList<QpMetaProperty> QpLegacySqlDatasourceData::changedRelations(const QpMetaObject &metaObject,
+                                                                  const QpDataTransferObject &changes) const
+{
+    QList<QpMetaProperty> result;
+    foreach (const QpMetaProperty relation, metaObject.relationProperties()) {
+        int propertyIndex = relation.metaProperty().propertyIndex();
+        if (changes.toOneRelationFKs.contains(propertyIndex)
+            || changes.toManyRelationFKsAdded.contains(propertyIndex)
+            || changes.toManyRelationFKsRemoved.contains(propertyIndex)) {
+            result.append(relation);
+        }
+    }
+    return result;
+}
+
+// Compares the related keys of a to-many relation with the keys, which have been
+// read or written the last time. Returns false, if the latter are unknown.
+bool QpLegacySqlDatasourceData::relatedKeysChanges(const QpMetaProperty &relation,
+                                                   const QObject *object,
+                                                   QList<int> &added,
+                                                   QList<int> &removed) const
+{
+    int propertyIndex = relation.metaProperty().propertyIndex();
+    if (!QpDataTransferObject::fromObject(object).toManyRelationFKs.contains(propertyIndex))
+        return false;
+
+    QpDataTransferObject changes = QpDataTransferObject::changesInObject(object);
+    added = changes.toManyRelationFKsAdded.value(propertyIndex);
+    removed = changes.toManyRelationFKsRemoved.value(propertyIndex);
+    return true;
+}
+
+// One IN list condition for each chunk of keys, which fits into a statement
+QList<QpCondition> QpLegacySqlDatasourceData::keysConditions(const QString &field, const QList<int> &keys) const
+{
+    QVariantList values;
+    values.reserve(keys.size());
+    foreach (int key, keys) {
+        values.append(key);
+    }
+    return QpCondition(field, QpCondition::In, values).splitInLists(maximumInListSize());
+}
+
 QList<QpSqlQuery> QpLegacySqlDatasourceData::queriesThatAdjustOneToOneRelation(const QpMetaProperty &relation, const QObject *object, QpError &error) const
 {
     if (relation.hasTableForeignKey())
@@ -348,25 +859,82 @@ QList<QpSqlQuery> QpLegacySqlDatasourceData::queriesThatAdjustOneToOneRelation(c
     return queries;
 }
 
-QList<QpSqlQuery> QpLegacySqlDatasourceData::queriesThatAdjustOneToManyRelation(const QpMetaProperty &relation, const QObject *object, QpError &error) const
-{
-    Q_UNUSED(error);
+QList<QpSqlQuery> QpLegacySqlDatasourceData::queriesThatAdjustOneToManyRelation(const QpMetaProperty &relation, const QObject *object, QpError &error) const
+{
+    Q_UNUSED(error);
+
+    QList<QpSqlQuery> queries;
+    QVariant primaryKey = Qp::Private::primaryKey(object);
+
+    // Only the objects, which have been added or removed since the last write, are touched
+    QList<int> addedKeys;
+    QList<int> removedKeys;
+    if (relatedKeysChanges(relation, object, addedKeys, removedKeys)) {
+        // Reset the foreign keys of removed objects, unless they have been related with another object meanwhile
+        foreach (const QpCondition &removed, keysConditions(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, removedKeys)) {
+            QpSqlQuery resetRelationQuery(database);
+            resetRelationQuery.setTable(relation.tableName());
+            resetRelationQuery.addField(relation.columnName(), QVariant());
+#ifndef QP_NO_TIMESTAMPS
+            resetRelationQuery.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, QpSqlBackend::forDatabase(database)->nowTimestamp());
+#endif
+            resetRelationQuery.setWhereCondition(QpCondition(relation.columnName(), QpCondition::EqualTo, primaryKey) && removed);
+            resetRelationQuery.prepareUpdate();
+            queries.append(resetRelationQuery);
+        }
+
+        foreach (const QpCondition &added, keysConditions(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, addedKeys)) {
+#ifndef QP_NO_TIMESTAMPS
+            // The objects, with which the added objects have been related before, change as well
+            QpCondition addedWithTable = added;
+            addedWithTable.setTable(relation.tableName());
+            addedWithTable.setBindValuesAsString(true);
+            QString updateTimeQueryString = QString("UPDATE %1 AS tableToUpdate"
+                                                    "\n\tINNER JOIN %2 "
+                                                    "\n\t\tON %2.%3 = tableToUpdate.%4 "
+                                                    "\n\tSET tableToUpdate.%5 = %6 "
+                                                    "\n\tWHERE %7")
+                                            .arg(QpSqlQuery::escapeField(relation.metaObject().tableName()))
+                                            .arg(QpSqlQuery::escapeField(relation.tableName()))
+                                            .arg(QpSqlQuery::escapeField(relation.columnName()))
+                                            .arg(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY)
+                                            .arg(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME)
+                                            .arg(QpSqlBackend::forDatabase(database)->nowTimestamp())
+                                            .arg(addedWithTable.toSqlClause());
+
+            QpSqlQuery setUpdateTimeOnPreviouslyRelatedObjectsQuery(database);
+            setUpdateTimeOnPreviouslyRelatedObjectsQuery.prepare(updateTimeQueryString);
+            queries.append(setUpdateTimeOnPreviouslyRelatedObjectsQuery);
+#endif
 
-    QList<QpSqlQuery> queries;
-    QVariant primaryKey = Qp::Private::primaryKey(object);
+            QpSqlQuery setForeignKeysQuery(database);
+            setForeignKeysQuery.setTable(relation.tableName());
+            setForeignKeysQuery.addField(relation.columnName(), primaryKey);
+#ifndef QP_NO_TIMESTAMPS
+            setForeignKeysQuery.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, QpSqlBackend::forDatabase(database)->nowTimestamp());
+#endif
+            setForeignKeysQuery.setWhereCondition(added);
+            setForeignKeysQuery.prepareUpdate();
+            queries.append(setForeignKeysQuery);
+        }
+
+        return queries;
+    }
 
     QList<QSharedPointer<QObject> > relatedObjects = Qp::Private::objectListCast(relation.metaProperty().read(object));
 
-    // Build an OR'd where clause, which matches all now related objects
-    QList<QpCondition> relatedObjectsWhereClauses;
+    // Build an IN list, which matches all now related objects. The keys are written into the SQL
+    // instead of being bound, so that any number of related objects fits into one statement.
+    QVariantList relatedKeys;
     foreach (QSharedPointer<QObject> relatedObject, relatedObjects) {
-        relatedObjectsWhereClauses.append(QpCondition(QString("%1.%2")
-                                                      .arg(relation.tableName())
-                                                      .arg(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY),
-                                                      QpCondition::EqualTo,
-                                                      Qp::Private::primaryKey(relatedObject.data())));
+        relatedKeys.append(Qp::Private::primaryKey(relatedObject.data()));
     }
-    QpCondition relatedObjectsWhereClause(QpCondition::Or, relatedObjectsWhereClauses);
+    QpCondition relatedObjectsWhereClause(QString("%1.%2")
+                                          .arg(relation.tableName())
+                                          .arg(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY),
+                                          QpCondition::In,
+                                          relatedKeys);
+    relatedObjectsWhereClause.setBindValuesAsString(true);
 
     // The reset condition matches all objects, which have previously been related with me, but are not now
     QpCondition resetCondition = QpCondition(relation.columnName(),
@@ -522,23 +1090,66 @@ QList<QpSqlQuery> QpLegacySqlDatasourceData::queriesThatAdjustManyToManyRelation
     QList<QpSqlQuery> queries;
     QVariant primaryKey = Qp::Private::primaryKey(object);
 
+    // Only the relations with objects, which have been added or removed since the last write, are touched
+    QList<int> addedKeys;
+    QList<int> removedKeys;
+    if (relatedKeysChanges(relation, object, addedKeys, removedKeys)) {
+        QString reverseColumn = relation.reverseRelation().columnName();
+
+#ifndef QP_NO_TIMESTAMPS
+        foreach (const QpCondition &changed, keysConditions(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, addedKeys + removedKeys)) {
+            QpSqlQuery setUpdateTimeOnChangedObjectsQuery(database);
+            setUpdateTimeOnChangedObjectsQuery.setTable(relation.reverseRelation().metaObject().tableName());
+            setUpdateTimeOnChangedObjectsQuery.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, QpSqlBackend::forDatabase(database)->nowTimestamp());
+            setUpdateTimeOnChangedObjectsQuery.setWhereCondition(changed);
+            setUpdateTimeOnChangedObjectsQuery.prepareUpdate();
+            queries.append(setUpdateTimeOnChangedObjectsQuery);
+        }
+#endif
+
+        foreach (const QpCondition &removed, keysConditions(reverseColumn, removedKeys)) {
+            QpSqlQuery removeNowUnrelatedQuery(database);
+            removeNowUnrelatedQuery.setTable(relation.tableName());
+            removeNowUnrelatedQuery.setWhereCondition(QpCondition(relation.columnName(), QpCondition::EqualTo, primaryKey) && removed);
+            removeNowUnrelatedQuery.prepareDelete();
+            queries.append(removeNowUnrelatedQuery);
+        }
+
+        // Each row binds two values
+        int rowsPerInsert = qMax(1, maximumInListSize());
+        for (int start = 0; start < addedKeys.size(); start += rowsPerInsert) {
+            QpSqlQuery createRelationsQuery(database);
+            createRelationsQuery.setOrIgnore(true);
+            createRelationsQuery.setTable(relation.tableName());
+            foreach (int relatedKey, addedKeys.mid(start, rowsPerInsert)) {
+                QHash<QString, QVariant> row;
+                row.insert(relation.columnName(), primaryKey);
+                row.insert(reverseColumn, relatedKey);
+                createRelationsQuery.addInsertRow(row);
+            }
+            createRelationsQuery.prepareInsert();
+            queries.append(createRelationsQuery);
+        }
+
+        return queries;
+    }
+
     QList<QSharedPointer<QObject> > relatedObjects = Qp::Private::objectListCast(relation.metaProperty().read(object));
 
-    // Build an OR'd where clause, which matches all now related objects
-    QList<QpCondition> relatedObjectsWhereClauses;
-    QList<QpCondition> relatedObjectsWhereClauses2;
+    // Build IN lists, which match all now related objects. The keys are written into the SQL
+    // instead of being bound, so that any number of related objects fits into one statement.
+    QVariantList relatedKeys;
     foreach (QSharedPointer<QObject> relatedObject, relatedObjects) {
-        relatedObjectsWhereClauses.append(QpCondition(relation.reverseRelation().columnName(),
-                                                      QpCondition::EqualTo,
-                                                      Qp::Private::primaryKey(relatedObject.data())));
-        relatedObjectsWhereClauses2.append(QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
-                                                       QpCondition::EqualTo,
-                                                       Qp::Private::primaryKey(relatedObject.data())));
-        // TODO: React to 999-clauses bug
+        relatedKeys.append(Qp::Private::primaryKey(relatedObject.data()));
     }
 
-    QpCondition relatedObjectsWhereClause(QpCondition::Or, relatedObjectsWhereClauses);
-    QpCondition relatedObjectsWhereClause2(QpCondition::Or, relatedObjectsWhereClauses2);
+    QpCondition relatedObjectsWhereClause(relation.reverseRelation().columnName(),
+                                          QpCondition::In,
+                                          relatedKeys);
+    relatedObjectsWhereClause.setBindValuesAsString(true);
+    QpCondition relatedObjectsWhereClause2(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
+                                           QpCondition::In,
+                                           relatedKeys);
     relatedObjectsWhereClause2.setBindValuesAsString(true);
 
     // The reset condition matches all objects, which have previously been related with me, but are not now
@@ -626,24 +1237,28 @@ void QpLegacySqlDatasourceData::readToManyRelations(QHash<int, QpDataTransferObj
     if (dataTransferObjects.isEmpty())
         return;
 
+    QList<QpCondition> parts = condition.splitInLists(maximumInListSize());
     foreach (QpMetaProperty relation, metaObject.relationProperties()) {
         if (!relation.isToManyRelationProperty())
             continue;
 
-        readToManyRelation(dataTransferObjects, relation, condition, error);
+        foreach (const QpCondition &part, parts) {
+            readToManyRelation(dataTransferObjects, relation, part, error);
+            if (error.isValid())
+                return;
+        }
     }
 }
 
-QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readObjects(const QpMetaObject &metaObject,
-                                                                        int skip,
-                                                                        int limit,
-                                                                        const QpCondition &condition,
-                                                                        QList<QpDatasource::OrderField> orders,
-                                                                        QpError &error) const
+QpSqlQuery QpLegacySqlDatasourceData::selectQuery(const QpMetaObject &metaObject,
+                                                  int skip,
+                                                  int limit,
+                                                  const QpCondition &condition,
+                                                  QList<QpDatasource::OrderField> orders) const
 {
     QpSqlQuery query(database);
     query.setTable(metaObject.tableName());
-    selectFields(metaObject, query);
+    query.setSelectClause(statementsFor(metaObject).selectClause);
     query.setWhereCondition(condition);
     query.setLimit(limit);
     query.setSkip(skip);
@@ -652,6 +1267,54 @@ QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readObjects(const Qp
         query.addOrder(orderField.field, static_cast<QpSqlQuery::Order>(orderField.order));
     }
     query.prepareSelect();
+    return query;
+}
+
+QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readObjects(const QpMetaObject &metaObject,
+                                                                        int skip,
+                                                                        int limit,
+                                                                        const QpCondition &condition,
+                                                                        QList<QpDatasource::OrderField> orders,
+                                                                        QpError &error,
+                                                                        QList<int> *primaryKeysInOrder) const
+{
+    // Oversized key sets are read with several statements
+    if (limit < 0 && skip < 0) {
+        QList<QpCondition> parts = condition.splitInLists(maximumInListSize());
+        if (parts.size() > 1) {
+            QHash<int, QpDataTransferObject> result;
+            foreach (const QpCondition &part, parts) {
+                QHash<int, QpDataTransferObject> dtos = readObjects(metaObject, -1, -1, part, orders, error, primaryKeysInOrder);
+                if (error.isValid())
+                    return QHash<int, QpDataTransferObject>();
+
+                for (auto it = dtos.constBegin(); it != dtos.constEnd(); ++it) {
+                    result.insert(it.key(), it.value());
+                }
+            }
+            return result;
+        }
+    }
+
+    QpSqlQuery query = selectQuery(metaObject, skip, limit, condition, orders);
+    if (!query.exec()) {
+        error = QpError(query);
+        return QHash<int, QpDataTransferObject>();
+    }
+
+    QHash<int, QpDataTransferObject> dataTransferObjects = readQuery(query, query.record(), metaObject, primaryKeysInOrder);
+    readToManyRelations(dataTransferObjects, metaObject, QpCondition::primaryKeys(dataTransferObjects.keys()), error);
+    return dataTransferObjects;
+}
+
+QHash<int, QpDataTransferObject> QpLegacySqlDatasourceData::readObject(const QpMetaObject &metaObject,
+                                                                       int primaryKey,
+                                                                       QpError &error) const
+{
+    QpSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepareStatement(statementsFor(metaObject).selectByPrimaryKey);
+    query.addBindValue(primaryKey);
 
     if (!query.exec()) {
         error = QpError(query);
@@ -733,6 +1396,60 @@ void QpLegacySqlDatasourceData::readToManyRelation(QHash<int, QpDataTransferObje
     }
 }
 
+/******************************************************************************
+ * QpLegacySqlDatasourceCursor
+ */
+class QpLegacySqlDatasourceCursor : public QpDatasourceCursor
+{
+public:
+    QpLegacySqlDatasourceCursor(const QSharedDataPointer<QpLegacySqlDatasourceData> &data,
+                                const QpMetaObject &metaObject,
+                                const QpSqlQuery &query);
+
+    void fetch(QpDatasourceResult *result, int count) Q_DECL_OVERRIDE;
+
+private:
+    const QSharedDataPointer<QpLegacySqlDatasourceData> data;
+    QpMetaObject metaObject;
+    QpSqlQuery query;
+    QSqlRecord record;
+};
+
+QpLegacySqlDatasourceCursor::QpLegacySqlDatasourceCursor(const QSharedDataPointer<QpLegacySqlDatasourceData> &data,
+                                                         const QpMetaObject &metaObject,
+                                                         const QpSqlQuery &query) :
+    data(data),
+    metaObject(metaObject),
+    query(query),
+    record(query.record())
+{
+}
+
+void QpLegacySqlDatasourceCursor::fetch(QpDatasourceResult *result, int count)
+{
+    QList<int> primaryKeys;
+    QHash<int, QpDataTransferObject> dataTransferObjects;
+    while (primaryKeys.size() < count && query.next()) {
+        QpDataTransferObject dto = data->readRow(query, record, metaObject);
+        primaryKeys << dto.primaryKey;
+        dataTransferObjects.insert(dto.primaryKey, dto);
+    }
+
+    QpError error;
+    data->readToManyRelations(dataTransferObjects, metaObject, QpCondition::primaryKeys(primaryKeys), error);
+    if (error.isValid()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
+        return;
+    }
+
+    // Keep the order of the statement
+    foreach (int primaryKey, primaryKeys) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "addDataTransferObject", Qt::AutoConnection, Q_ARG(QpDataTransferObject, dataTransferObjects.value(primaryKey))));
+    }
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+}
+
+
 /******************************************************************************
  * QpLegacySqlDatasource
  */
@@ -744,11 +1461,22 @@ QpLegacySqlDatasource::QpLegacySqlDatasource(QObject *parent) :
 
 QpLegacySqlDatasource::~QpLegacySqlDatasource()
 {
+    if (!data->ownsDatabase)
+        return;
+
+    // No query or copy of the connection may be left, when it is removed
+    QString connectionName = data->database.connectionName();
+    data->statements.clear();
+    QpSqlQuery::removeStatementCache(data->database);
+    data->database.close();
+    data->database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
 }
 
 QpDatasource *QpLegacySqlDatasource::cloneForThread(QThread *thread) const
 {
     QpLegacySqlDatasource *clone = new QpLegacySqlDatasource();
+    clone->setReadBackAfterWriteEnabled(data->readBackAfterWrite);
     clone->moveToThread(thread);
     Q_ASSUME(QMetaObject::invokeMethod(clone, "cloneDatabase", Qt::AutoConnection, Q_ARG(QSqlDatabase, data->database)));
     return clone;
@@ -761,7 +1489,58 @@ QSqlDatabase QpLegacySqlDatasource::database() const
 
 void QpLegacySqlDatasource::setSqlDatabase(const QSqlDatabase &database)
 {
+    // The statements of the previous connection are not used anymore
+    if (data->database.connectionName() != database.connectionName())
+        QpSqlQuery::removeStatementCache(data->database);
+
     data->database = database;
+    data->autoIncrementLockMode = -1;
+    data->autoIncrementIncrement = 1;
+    data->tableRecords.clear();
+    data->statements.clear();
+}
+
+void QpLegacySqlDatasource::clearSchemaCache()
+{
+    // The generated SQL and the prepared statements might refer to columns, which have changed
+    data->tableRecords.clear();
+    data->statements.clear();
+    QpSqlQuery::clearStatementCache(data->database);
+}
+
+bool QpLegacySqlDatasource::isReadBackAfterWriteEnabled() const
+{
+    return data->readBackAfterWrite;
+}
+
+void QpLegacySqlDatasource::setReadBackAfterWriteEnabled(bool enabled)
+{
+    data->readBackAfterWrite = enabled;
+}
+
+void QpLegacySqlDatasource::finishWrite(QpDatasourceResult *result, const QpMetaObject &metaObject, const QList<int> &primaryKeys) const
+{
+    QpError error;
+    QpDataTransferObjectsById dtos;
+
+    // Re-reading the whole object is only needed, if the database changes its contents on its own (e.g. with triggers)
+    if (data->readBackAfterWrite) {
+        if (primaryKeys.size() == 1)
+            dtos = data->readObject(metaObject, primaryKeys.first(), error);
+        else if (!primaryKeys.isEmpty())
+            dtos = data->readObjects(metaObject, -1, -1, QpCondition::primaryKeys(primaryKeys), {}, error);
+    }
+    else {
+        dtos = data->readWriteBack(metaObject, primaryKeys, error);
+    }
+
+    if (error.isValid()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
+        return;
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setDataTransferObjects", Qt::AutoConnection, Q_ARG(QpDataTransferObjectsById, dtos)));
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
 }
 
 QpDatasource::Features QpLegacySqlDatasource::features() const
@@ -793,6 +1572,34 @@ void QpLegacySqlDatasource::count(QpDatasourceResult *result, const QpMetaObject
     Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
 }
 
+void QpLegacySqlDatasource::approximateCount(QpDatasourceResult *result, const QpMetaObject &metaObject) const
+{
+    QpSqlQuery query(data->database);
+#ifdef QP_FOR_MYSQL
+    // The row count of the table statistics, which may be off by some percent
+    QString q = QString::fromLatin1(
+                "SELECT `TABLE_ROWS` "
+                "FROM  INFORMATION_SCHEMA.TABLES "
+                "WHERE TABLE_SCHEMA = '%1' "
+                "AND   TABLE_NAME   = '%2';")
+                .arg(data->database.databaseName())
+                .arg(metaObject.tableName());
+#else
+    // SQLite has no statistics. The largest key is an upper bound, which does not need to scan the table.
+    QString q = QString::fromLatin1("SELECT MAX(%1) FROM %2")
+                .arg(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY)
+                .arg(QpSqlQuery::escapeField(metaObject.tableName()));
+#endif
+
+    if (!query.exec(q) || !query.first()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
+        return;
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setIntegerResult", Qt::AutoConnection, Q_ARG(int, query.value(0).toInt())));
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+}
+
 void QpLegacySqlDatasource::latestRevision(QpDatasourceResult *result, const QpMetaObject &metaObject) const
 {
     QpSqlQuery query(data->database);
@@ -832,9 +1639,7 @@ void QpLegacySqlDatasource::maxPrimaryKey(QpDatasourceResult *result, const QpMe
 void QpLegacySqlDatasource::objectByPrimaryKey(QpDatasourceResult *result, const QpMetaObject &metaObject, int primaryKey) const
 {
     QpError error;
-    QHash<int, QpDataTransferObject> dtos = data->readObjects(metaObject, -1, -1, QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
-                                                                                              QpCondition::EqualTo,
-                                                                                              primaryKey), {}, error);
+    QHash<int, QpDataTransferObject> dtos = data->readObject(metaObject, primaryKey, error);
     if (error.isValid()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
         return;
@@ -852,27 +1657,52 @@ void QpLegacySqlDatasource::objects(QpDatasourceResult *result,
                                     QList<QpDatasource::OrderField> orders) const
 {
     QpError error;
-    QHash<int, QpDataTransferObject> dtos = data->readObjects(metaObject, skip, limit, condition, orders, error);
+    QList<int> primaryKeysInOrder;
+    QHash<int, QpDataTransferObject> dtos = data->readObjects(metaObject, skip, limit, condition, orders, error, &primaryKeysInOrder);
     if (error.isValid()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
         return;
     }
 
-    Q_ASSUME(QMetaObject::invokeMethod(result, "setDataTransferObjects", Qt::AutoConnection, Q_ARG(QpDataTransferObjectsById, dtos)));
+    // Keep the order of the statement, which the hash has lost
+    QpDataTransferObjectList orderedDtos;
+    orderedDtos.reserve(primaryKeysInOrder.size());
+    foreach (int primaryKey, primaryKeysInOrder) {
+        orderedDtos.append(dtos.value(primaryKey));
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setDataTransferObjects", Qt::AutoConnection, Q_ARG(QpDataTransferObjectList, orderedDtos)));
     Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
 }
 
+QpDatasourceCursor *QpLegacySqlDatasource::openCursor(QpDatasourceResult *result,
+                                                      const QpMetaObject &metaObject,
+                                                      const QpCondition &condition,
+                                                      QList<QpDatasource::OrderField> orders) const
+{
+    QpSqlQuery query = data->selectQuery(metaObject, -1, -1, condition, orders);
+    if (!query.exec()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
+        return nullptr;
+    }
+
+    return new QpLegacySqlDatasourceCursor(data, metaObject, query);
+}
+
 void QpLegacySqlDatasource::objectsUpdatedAfterRevision(QpDatasourceResult *result, const QpMetaObject &metaObject, int revision) const
 {
-    QString qualifiedRevisionField = QString::fromLatin1("%1.%2")
-                                     .arg(QpSqlQuery::escapeField("history_subselect"))
-                                     .arg(QpSqlQuery::escapeField(QpDatabaseSchema::COLUMN_NAME_REVISION));
+    // Without materialized revisions, the revision and action come from the history subselect
+    QString revisionTable = data->hasColumn(metaObject, QpDatabaseSchema::COLUMN_NAME_REVISION)
+                            ? metaObject.tableName()
+                            : QString::fromLatin1("history_subselect");
+    QString qualifiedRevisionField = QpSqlQuery::escapeField(revisionTable, QpDatabaseSchema::COLUMN_NAME_REVISION);
+    QString qualifiedActionField = QpSqlQuery::escapeField(revisionTable, QpDatabaseSchema::COLUMN_NAME_ACTION);
     QpError error;
     QHash<int, QpDataTransferObject> dtos = data->readObjects(metaObject, -1, -1,
                                                               QString::fromLatin1("%1 > %2 AND %3 in ('UPDATE', 'MARK_AS_DELETE')")
                                                               .arg(qualifiedRevisionField)
                                                               .arg(revision)
-                                                              .arg(QpDatabaseSchema::COLUMN_NAME_ACTION),
+                                                              .arg(qualifiedActionField),
                                                               {{qualifiedRevisionField, QpDatasource::Ascending}}, error);
     if (error.isValid()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
@@ -896,64 +1726,164 @@ void QpLegacySqlDatasource::objectRevision(QpDatasourceResult *result, const QOb
     Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
 }
 
+void QpLegacySqlDatasource::objectRevisions(QpDatasourceResult *result, const QpMetaObject &metaObject, const QList<int> &primaryKeys) const
+{
+    QpError error;
+    QpDataTransferObjectsById revisions = data->objectRevisions(metaObject, primaryKeys, error);
+    if (error.isValid()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
+        return;
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setDataTransferObjects", Qt::AutoConnection, Q_ARG(QpDataTransferObjectsById, revisions)));
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+}
+
 void QpLegacySqlDatasource::insertObject(QpDatasourceResult *result, const QObject *object) const
 {
     QpMetaObject metaObject = QpMetaObject::forObject(object);
 
-    // Create main INSERT query
+    // Create main INSERT query. NULL values are bound as invalid variants.
     QpSqlQuery query(data->database);
-    query.setTable(metaObject.tableName());
-    data->fillValuesIntoQuery(object, query);
-
-#ifndef QP_NO_TIMESTAMPS
-    query.addRawField(QpDatabaseSchema::COLUMN_NAME_CREATION_TIME, QpSqlBackend::forDatabase(data->database)->nowTimestamp());
-#endif
+    query.prepareStatement(data->statementsFor(metaObject).insert);
+    foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+        query.addBindValue(data->sqlValue(property, object));
+    }
 
     // Insert the object itself
-    query.prepareInsert();
     if (!query.exec()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
         return;
     }
 
-    objectByPrimaryKey(result, metaObject, query.lastInsertId().toInt());
+    finishWrite(result, metaObject, QList<int>() << query.lastInsertId().toInt());
 }
 
-void QpLegacySqlDatasource::updateObject(QpDatasourceResult *result, const QObject *object) const
+void QpLegacySqlDatasource::insertObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const
 {
-    QpMetaObject metaObject = QpMetaObject::forObject(object);
-    int primaryKey = Qp::Private::primaryKey(object);
+    // Limits the size of a single statement independently of the placeholder limit
+    static const int MAXIMUM_ROWS_PER_INSERT = 1000;
 
-    // Create main UPDATE query
-    QpSqlQuery query(data->database);
-    query.setTable(metaObject.tableName());
-    query.setWhereCondition(QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
-                                        QpCondition::EqualTo,
-                                        primaryKey));
-    data->fillValuesIntoQuery(object, query);
+    if (objects.isEmpty()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+        return;
+    }
+
+    QpMetaObject metaObject = QpMetaObject::forObject(objects.first());
+    QpSqlBackend *backend = QpSqlBackend::forDatabase(data->database);
+
+    QList<QHash<QString, QVariant> > rows;
+    rows.reserve(objects.size());
+    foreach (const QObject *object, objects) {
+        rows.append(data->insertRow(object));
+    }
+
+    int columnCount = qMax(1, rows.first().size());
+    int chunkSize = qBound(1, backend->maximumBindValueCount() / columnCount, MAXIMUM_ROWS_PER_INSERT);
+
+    // Without consecutive keys only the key of a single-row INSERT is known
+    if (!data->hasConsecutiveInsertKeys())
+        chunkSize = 1;
 
-    query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, Qp::Private::isDeleted(object));
+    // The DTOs are in the order of the objects
+    QpDataTransferObjectList dtos;
+    dtos.reserve(objects.size());
+    for (int start = 0; start < rows.size(); start += chunkSize) {
+        int rowCount = qMin(chunkSize, rows.size() - start);
 
+        QpSqlQuery query(data->database);
+        query.setTable(metaObject.tableName());
+        for (int i = start; i < start + rowCount; ++i) {
+            query.addInsertRow(rows.at(i));
+        }
 #ifndef QP_NO_TIMESTAMPS
-    query.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, QpSqlBackend::forDatabase(data->database)->nowTimestamp());
+        query.addRawField(QpDatabaseSchema::COLUMN_NAME_CREATION_TIME, backend->nowTimestamp());
 #endif
 
-    // Insert the object itself
-    query.prepareUpdate();
+        query.prepareInsert();
+        if (!query.exec()) {
+            Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
+            return;
+        }
+
+        // The rows of a multi-row INSERT get consecutive keys in their order (see hasConsecutiveInsertKeys())
+        QList<int> chunkKeys;
+        chunkKeys.reserve(rowCount);
+#ifdef QP_FOR_SQLITE
+        // SQLite reports the key of the last row...
+        int lastKey = query.lastInsertId().toInt();
+        for (int i = 0; i < rowCount; ++i) {
+            chunkKeys.append(lastKey - rowCount + 1 + i);
+        }
+#else
+        // ...MySQL reports the key of the first row
+        int firstKey = query.lastInsertId().toInt();
+        for (int i = 0; i < rowCount; ++i) {
+            chunkKeys.append(firstKey + i * data->autoIncrementIncrement);
+        }
+#endif
+
+        // Read back the keys and revisions of the whole chunk with one query, as finishWrite() does
+        QpError error;
+        QpDataTransferObjectsById chunk;
+        if (data->readBackAfterWrite)
+            chunk = data->readObjects(metaObject, -1, -1, QpCondition::primaryKeys(chunkKeys), {}, error);
+        else
+            chunk = data->readWriteBack(metaObject, chunkKeys, error);
+
+        if (!error.isValid() && chunk.size() != rowCount)
+            error = QpError(QString::fromLatin1("Could not read back the %1 objects inserted into %2")
+                            .arg(rowCount)
+                            .arg(metaObject.tableName()),
+                            QpError::SqlError);
+
+        if (error.isValid()) {
+            Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
+            return;
+        }
+
+        foreach (int key, chunkKeys) {
+            dtos.append(chunk.value(key));
+        }
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setDataTransferObjects", Qt::AutoConnection, Q_ARG(QpDataTransferObjectList, dtos)));
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+}
+
+void QpLegacySqlDatasource::updateObject(QpDatasourceResult *result, const QObject *object) const
+{
+    QpMetaObject metaObject = QpMetaObject::forObject(object);
+    int primaryKey = Qp::Private::primaryKey(object);
+    // Optimistic concurrency: The UPDATE only matches the row, if nobody else has updated it since we have read it
+    QVariant version = QpDataTransferObject::fromObject(object).dynamicProperties.value(QpDatabaseSchema::COLUMN_NAME_VERSION);
+
+    QList<QpMetaProperty> relations;
+    QpSqlQuery query = data->updateQuery(object, relations);
+
+    // Update the object itself
     if (!query.exec()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
         return;
     }
 
+    // The integer result is the number of updated rows, which is 0 for a conflicting update
+    if (version.isValid() && query.numRowsAffected() == 0) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setIntegerResult", Qt::AutoConnection, Q_ARG(int, 0)));
+        Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+        return;
+    }
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setIntegerResult", Qt::AutoConnection, Q_ARG(int, 1)));
+
     // Update related objects
     QpError error;
-    data->adjustRelationsInDatabase(object, error);
+    data->adjustRelationsInDatabase(object, relations, error);
     if (error.isValid()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
         return;
     }
 
-    objectByPrimaryKey(result, metaObject, primaryKey);
+    finishWrite(result, metaObject, QList<int>() << primaryKey);
 }
 
 void QpLegacySqlDatasource::removeObject(QpDatasourceResult *result, const QObject *object) const
@@ -961,17 +1891,76 @@ void QpLegacySqlDatasource::removeObject(QpDatasourceResult *result, const QObje
     QpMetaObject metaObject = QpMetaObject::forObject(object);
 
     QpSqlQuery query(data->database);
-    query.setTable(metaObject.tableName());
-    query.setWhereCondition(QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
-                                        QpCondition::EqualTo,
-                                        Qp::Private::primaryKey(object)));
-    query.prepareDelete();
+    query.prepareStatement(data->statementsFor(metaObject).remove);
+    query.addBindValue(Qp::Private::primaryKey(object));
 
     if (!query.exec()) {
         Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(query))));
     }
 }
 
+void QpLegacySqlDatasource::updateObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const
+{
+    if (objects.isEmpty()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+        return;
+    }
+
+    QpMetaObject metaObject = QpMetaObject::forObject(objects.first());
+    QList<int> primaryKeys;
+    primaryKeys.reserve(objects.size());
+
+    // The UPDATEs and the relation adjustments are collected and executed as batches of equal statements
+    QpError error;
+    QpSqlQuery::startBulkExec();
+    foreach (const QObject *object, objects) {
+        QList<QpMetaProperty> relations;
+        QpSqlQuery query = data->updateQuery(object, relations);
+        if (!query.exec()) {
+            error = QpError(query);
+            break;
+        }
+
+        data->adjustRelationsInDatabase(object, relations, error);
+        if (error.isValid())
+            break;
+
+        primaryKeys.append(Qp::Private::primaryKey(object));
+    }
+
+    QSqlError bulkError = QpSqlQuery::bulkExec();
+    if (!error.isValid() && bulkError.isValid())
+        error = QpError(bulkError);
+
+    if (error.isValid()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
+        return;
+    }
+
+    finishWrite(result, metaObject, primaryKeys);
+}
+
+void QpLegacySqlDatasource::removeObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const
+{
+    if (objects.isEmpty())
+        return;
+
+    QString remove = data->statementsFor(QpMetaObject::forObject(objects.first())).remove;
+
+    QpSqlQuery::startBulkExec();
+    foreach (const QObject *object, objects) {
+        QpSqlQuery query(data->database);
+        query.prepareStatement(remove);
+        query.addBindValue(Qp::Private::primaryKey(object));
+        query.exec();
+    }
+
+    QSqlError error = QpSqlQuery::bulkExec();
+    if (error.isValid()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(error))));
+    }
+}
+
 void QpLegacySqlDatasource::incrementNumericColumn(QpDatasourceResult *result, const QObject *object, const QString &fieldName) const
 {
     static const int TRY_COUNT_MAX = 100;
@@ -1004,11 +1993,52 @@ void QpLegacySqlDatasource::incrementNumericColumn(QpDatasourceResult *result, c
         QThread::usleep(100);
     } while (true);
 
-    objectByPrimaryKey(result, mo, primaryKey);
+    // Only a full re-read contains the incremented value
+    if (data->readBackAfterWrite) {
+        objectByPrimaryKey(result, mo, primaryKey);
+        return;
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
+}
+
+void QpLegacySqlDatasource::reserveSequenceValues(QpDatasourceResult *result, const QpMetaObject &metaObject, const QString &fieldName, int count) const
+{
+    Q_ASSERT(count > 0);
+
+#ifdef QP_FOR_SQLITE
+    // A savepoint starts a transaction outside of one and nests inside of one. The UPDATE locks
+    // the database until the savepoint is released, so that nobody can advance the sequence
+    // between our UPDATE and SELECT.
+    QpSqlQuery savepoint(data->database);
+    if (!savepoint.exec(QLatin1String("SAVEPOINT _Qp_sequence"))) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, QpError(savepoint))));
+        return;
+    }
+#endif
+
+    QpError error;
+    int lastValue = data->advanceSequence(metaObject, fieldName, count, error);
+
+#ifdef QP_FOR_SQLITE
+    if (error.isValid())
+        savepoint.exec(QLatin1String("ROLLBACK TO _Qp_sequence"));
+    if (!savepoint.exec(QLatin1String("RELEASE _Qp_sequence")) && !error.isValid())
+        error = QpError(savepoint);
+#endif
+
+    if (error.isValid()) {
+        Q_ASSUME(QMetaObject::invokeMethod(result, "setLastError", Qt::AutoConnection, Q_ARG(QpError, error)));
+        return;
+    }
+
+    Q_ASSUME(QMetaObject::invokeMethod(result, "setIntegerResult", Qt::AutoConnection, Q_ARG(int, lastValue)));
+    Q_ASSUME(QMetaObject::invokeMethod(result, "finish", Qt::AutoConnection));
 }
 
 void QpLegacySqlDatasource::cloneDatabase(const QSqlDatabase &database)
 {
     data->database = QSqlDatabase::cloneDatabase(database, database.connectionName().append(QThread::currentThread()->objectName()));
+    data->ownsDatabase = true;
     Q_ASSUME(data->database.open());
 }
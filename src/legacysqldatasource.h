@@ -27,26 +27,40 @@ public:
     QSqlDatabase database() const;
     void setSqlDatabase(const QSqlDatabase &database);
 
+    bool isReadBackAfterWriteEnabled() const;
+    void setReadBackAfterWriteEnabled(bool enabled);
+
     QpDatasource::Features features() const Q_DECL_OVERRIDE;
 
+    QpDatasourceCursor *openCursor(QpDatasourceResult *result, const QpMetaObject &metaObject, const QpCondition &condition, QList<QpDatasource::OrderField> orders) const Q_DECL_OVERRIDE;
+
 public slots:
+    void clearSchemaCache() Q_DECL_OVERRIDE;
     void count(QpDatasourceResult *result, const QpMetaObject &metaObject, const QpCondition &condition) const Q_DECL_OVERRIDE;
+    void approximateCount(QpDatasourceResult *result, const QpMetaObject &metaObject) const Q_DECL_OVERRIDE;
     void latestRevision(QpDatasourceResult *result, const QpMetaObject &metaObject) const Q_DECL_OVERRIDE;
     void maxPrimaryKey(QpDatasourceResult *result, const QpMetaObject &metaObject) const Q_DECL_OVERRIDE;
     void objectByPrimaryKey(QpDatasourceResult *result, const QpMetaObject &metaObject, int primaryKey) const Q_DECL_OVERRIDE;
     void objects(QpDatasourceResult *result, const QpMetaObject &metaObject, int skip, int limit, const QpCondition &condition, QList<QpDatasource::OrderField> orders) const Q_DECL_OVERRIDE;
     void objectsUpdatedAfterRevision(QpDatasourceResult *result, const QpMetaObject &metaObject, int revision) const Q_DECL_OVERRIDE;
     void objectRevision(QpDatasourceResult *result, const QObject *object) const Q_DECL_OVERRIDE;
+    void objectRevisions(QpDatasourceResult *result, const QpMetaObject &metaObject, const QList<int> &primaryKeys) const Q_DECL_OVERRIDE;
     void insertObject(QpDatasourceResult *result, const QObject *object) const Q_DECL_OVERRIDE;
+    void insertObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const Q_DECL_OVERRIDE;
     void updateObject(QpDatasourceResult *result, const QObject *object) const Q_DECL_OVERRIDE;
+    void updateObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const Q_DECL_OVERRIDE;
     void removeObject(QpDatasourceResult *result, const QObject *object) const Q_DECL_OVERRIDE;
+    void removeObjects(QpDatasourceResult *result, const QList<QObject *> &objects) const Q_DECL_OVERRIDE;
     void incrementNumericColumn(QpDatasourceResult *result, const QObject *object, const QString &fieldName) const Q_DECL_OVERRIDE;
+    void reserveSequenceValues(QpDatasourceResult *result, const QpMetaObject &metaObject, const QString &fieldName, int count) const Q_DECL_OVERRIDE;
 
 private slots:
     void cloneDatabase(const QSqlDatabase &database);
 
 private:
     QSharedDataPointer<QpLegacySqlDatasourceData> data;
+
+    void finishWrite(QpDatasourceResult *result, const QpMetaObject &metaObject, const QList<int> &primaryKeys) const;
 };
 
 #endif // QPERSISTENCE_LEGACYSQLDATASOURCE_H
@@ -1,5 +1,14 @@
 #include "objectlistmodel.h"
 
+#include "error.h"
+#include "reply.h"
+
+BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QPointer>
+END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+
+#include <algorithm>
+
 
 /******************************************************************************
  * QpObjectListModelBaseData
@@ -11,18 +20,66 @@ public:
         QSharedData(),
         fetchCount(std::numeric_limits<int>::max()),
         dao(nullptr),
-        objectsFromDao(true)
+        objectsFromDao(true),
+        countMode(QpObjectListModelBase::ExactCount),
+        totalCount(-1),
+        atEnd(false),
+        asynchronous(false)
     {
     }
 
     int fetchCount;
-    mutable QHash<QSharedPointer<QObject>, int> rows;
+    QHash<QSharedPointer<QObject>, int> rows; //! Only for lists, which have been set with setObjects()
     QList<QSharedPointer<QObject> > objects;
+    QVector<int> keys; //! The ascending primary keys of the objects fetched from the DAO, to find rows by binary search
     QpDataAccessObjectBase *dao;
     bool objectsFromDao;
     QpCondition condition;
+    QList<QpDatasource::OrderField> orders;
+    QVariant lastKey; //! The primary key of the last fetched object, after which the next page starts
+    QpObjectListModelBase::CountMode countMode;
+    mutable int totalCount; //! -1 until it has been counted
+    bool atEnd; //! A page came back short, so there is nothing more to fetch
+    bool asynchronous;
+    QPointer<QpReply> pendingReply; //! The page, which is being read asynchronously
+    QpError lastError;
+
+    bool isKeyOrdered() const;
+    int row(QSharedPointer<QObject> object) const;
+    int insertionRow(int primaryKey) const;
 };
 
+bool QpObjectListModelBaseData::isKeyOrdered() const
+{
+    if (orders.isEmpty())
+        return true;
+
+    return orders.size() == 1
+            && orders.first().field == QLatin1String(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY)
+            && orders.first().order == QpDatasource::Ascending;
+}
+
+int QpObjectListModelBaseData::row(QSharedPointer<QObject> object) const
+{
+    if (!objectsFromDao)
+        return rows.value(object, -1);
+
+    if (!isKeyOrdered())
+        return objects.indexOf(object);
+
+    int primaryKey = Qp::Private::primaryKey(object.data());
+    int index = insertionRow(primaryKey);
+    if (index == keys.size() || keys.at(index) != primaryKey)
+        return -1;
+
+    return index;
+}
+
+int QpObjectListModelBaseData::insertionRow(int primaryKey) const
+{
+    return std::lower_bound(keys.constBegin(), keys.constEnd(), primaryKey) - keys.constBegin();
+}
+
 
 /******************************************************************************
  * QpObjectListModelBase
@@ -56,6 +113,43 @@ void QpObjectListModelBase::setFetchCount(int fetchCount)
         d->fetchCount = fetchCount;
 }
 
+QpObjectListModelBase::CountMode QpObjectListModelBase::countMode() const
+{
+    return d->countMode;
+}
+
+void QpObjectListModelBase::setCountMode(CountMode mode)
+{
+    d->countMode = mode;
+    invalidateTotalCount();
+}
+
+/*!
+ * The number of objects, which the model shows when all of them have been
+ * fetched. It is counted only once and recounted after objects have been
+ * created, removed, deleted or undeleted, or the condition has changed.
+ */
+int QpObjectListModelBase::totalCount() const
+{
+    if (!d->objectsFromDao)
+        return d->objects.size();
+
+    if (d->totalCount < 0) {
+        if (d->countMode == ApproximateCount)
+            d->totalCount = d->dao->approximateCount();
+        else
+            d->totalCount = d->dao->count(QpCondition::notDeletedAnd(d->condition));
+    }
+
+    return d->totalCount;
+}
+
+void QpObjectListModelBase::invalidateTotalCount()
+{
+    d->totalCount = -1;
+    d->atEnd = false;
+}
+
 QpDataAccessObjectBase *QpObjectListModelBase::dataAccessObject() const
 {
     return d->dao;
@@ -63,8 +157,40 @@ QpDataAccessObjectBase *QpObjectListModelBase::dataAccessObject() const
 
 void QpObjectListModelBase::setCondition(const QpCondition &condition)
 {
-    beginResetModel();
     d->condition = condition;
+    resetObjects();
+}
+
+QpCondition QpObjectListModelBase::condition() const
+{
+    return d->condition;
+}
+
+/*!
+ * Sets the order, in which the objects are read from the database. Pages are
+ * read by primary key as long as the order is the primary key, otherwise by
+ * offset, and the model is reset whenever an object is inserted or undeleted.
+ */
+void QpObjectListModelBase::setOrders(const QList<QpDatasource::OrderField> &orders)
+{
+    d->orders = orders;
+    resetObjects();
+}
+
+QList<QpDatasource::OrderField> QpObjectListModelBase::orders() const
+{
+    return d->orders;
+}
+
+void QpObjectListModelBase::resetObjects()
+{
+    beginResetModel();
+    cancelPendingFetch();
+    d->objects.clear();
+    d->keys.clear();
+    d->lastKey = QVariant();
+    d->lastError = QpError();
+    invalidateTotalCount();
     endResetModel();
 }
 
@@ -88,33 +214,145 @@ int QpObjectListModelBase::rowCount(const QModelIndex &parent) const
 
 bool QpObjectListModelBase::canFetchMore(const QModelIndex &) const
 {
-    if (!d->objectsFromDao)
+    if (!d->objectsFromDao || d->atEnd || d->pendingReply)
         return false;
 
-    return (d->objects.size() < d->dao->count(QpCondition::notDeletedAnd(d->condition)));
+    if (d->countMode == ApproximateCount)
+        return true;
+
+    return d->objects.size() < totalCount();
 }
 
 void QpObjectListModelBase::fetchMore(const QModelIndex &parent)
 {
     Q_UNUSED(parent)
 
-    if (!d->objectsFromDao)
+    if (!d->asynchronous) {
+        fetchMoreSynchronously();
         return;
+    }
 
-    int begin = d->objects.size();
-    int remainder = d->dao->count(QpCondition::notDeletedAnd(d->condition)) - begin;
-    int itemsToFetch = qMin(d->fetchCount, remainder);
+    if (d->pendingReply)
+        return;
 
-    beginInsertRows(QModelIndex(), begin, begin+itemsToFetch-1);
+    int count = itemsToFetch();
+    if (count <= 0)
+        return;
 
-    d->objects.append(d->dao->readAllObjects(begin, itemsToFetch, QpCondition::notDeletedAnd(d->condition)));
-    for (int i = begin; i < begin + itemsToFetch; ++i) {
-        d->rows.insert(d->objects.at(i), i);
+    QpReply *reply = nullptr;
+    if (d->isKeyOrdered())
+        reply = d->dao->readAllObjectsAfterAsync(d->lastKey, count, QpCondition::notDeletedAnd(d->condition));
+    else
+        reply = d->dao->readAllObjectsAsync(d->objects.size(), count, QpCondition::notDeletedAnd(d->condition), ordersWithKey());
+    d->pendingReply = reply;
+    connect(reply, &QpReply::finished, this, [this, reply, count] {
+        reply->deleteLater();
+
+        // The page has been cancelled or replaced
+        if (d->pendingReply != reply)
+            return;
+
+        d->pendingReply = nullptr;
+
+        // A failed page is not the end of the list, so that it can be fetched again
+        d->lastError = reply->lastError();
+        if (!d->lastError.isValid())
+            appendObjects(reply->objects(), count);
+        emit loadingChanged(false);
+    });
+
+    emit loadingChanged(true);
+}
+
+int QpObjectListModelBase::itemsToFetch() const
+{
+    if (!d->objectsFromDao || d->atEnd)
+        return 0;
+
+    int count = d->fetchCount;
+    if (d->countMode == ExactCount)
+        count = qMin(count, totalCount() - d->objects.size());
+
+    return count;
+}
+
+void QpObjectListModelBase::fetchMoreSynchronously()
+{
+    // A synchronous read replaces the page, which is being read asynchronously
+    cancelPendingFetch();
+
+    int count = itemsToFetch();
+    if (count <= 0)
+        return;
+
+    // Seek to the next page by primary key instead of skipping the rows before it,
+    // which the database would otherwise have to read again for each page.
+    if (d->isKeyOrdered())
+        appendObjects(d->dao->readAllObjectsAfter(d->lastKey, count, QpCondition::notDeletedAnd(d->condition)), count);
+    else
+        appendObjects(d->dao->readAllObjects(d->objects.size(), count, QpCondition::notDeletedAnd(d->condition), ordersWithKey()), count);
+}
+
+QList<QpDatasource::OrderField> QpObjectListModelBase::ordersWithKey() const
+{
+    // The primary key makes the order of equal values stable across pages
+    QpDatasource::OrderField key;
+    key.field = QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY;
+    key.order = QpDatasource::Ascending;
+    return QList<QpDatasource::OrderField>() << d->orders << key;
+}
+
+void QpObjectListModelBase::appendObjects(const QList<QSharedPointer<QObject> > &objects, int requestedCount)
+{
+    // The count has been an estimate or is outdated
+    if (objects.size() < requestedCount)
+        d->atEnd = true;
+
+    if (objects.isEmpty())
+        return;
+
+    int begin = d->objects.size();
+    beginInsertRows(QModelIndex(), begin, begin + objects.size() - 1);
+
+    d->objects.append(objects);
+    d->keys.reserve(d->objects.size());
+    foreach (QSharedPointer<QObject> object, objects) {
+        d->keys.append(Qp::Private::primaryKey(object.data()));
     }
+    d->lastKey = Qp::Private::primaryKey(objects.last().data());
 
     endInsertRows();
 }
 
+void QpObjectListModelBase::cancelPendingFetch()
+{
+    if (!d->pendingReply)
+        return;
+
+    d->pendingReply = nullptr;
+    emit loadingChanged(false);
+}
+
+bool QpObjectListModelBase::isAsynchronous() const
+{
+    return d->asynchronous;
+}
+
+void QpObjectListModelBase::setAsynchronous(bool asynchronous)
+{
+    d->asynchronous = asynchronous;
+}
+
+bool QpObjectListModelBase::isLoading() const
+{
+    return d->pendingReply;
+}
+
+QpError QpObjectListModelBase::lastError() const
+{
+    return d->lastError;
+}
+
 QVariant QpObjectListModelBase::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid())
@@ -144,14 +382,19 @@ QVariant QpObjectListModelBase::headerData(int section, Qt::Orientation orientat
 
 QModelIndex QpObjectListModelBase::indexForObjectBase(QSharedPointer<QObject> object) const
 {
-    while (!d->rows.contains(object)) {
-        if (!canFetchMore())
+    int row = d->row(object);
+    while (row < 0) {
+        // Pages are fetched in key order, so the object would have been fetched already
+        if (d->objectsFromDao && d->isKeyOrdered() && d->lastKey.isValid() && Qp::Private::primaryKey(object.data()) <= d->lastKey.toInt())
             return QModelIndex();
 
-        const_cast<QpObjectListModelBase *>(this)->fetchMore();
+        if (itemsToFetch() <= 0)
+            return QModelIndex();
+
+        const_cast<QpObjectListModelBase *>(this)->fetchMoreSynchronously();
+        row = d->row(object);
     }
 
-    int row = d->rows.value(object);
     return index(row);
 }
 
@@ -176,6 +419,7 @@ void QpObjectListModelBase::setObjects(QList<QSharedPointer<QObject> > objects)
 
     d->objectsFromDao = false;
     d->objects = objects;
+    d->keys.clear();
     d->rows.clear();
 
     for (int i = 0, count = objects.size(); i < count; ++i) {
@@ -187,6 +431,14 @@ void QpObjectListModelBase::setObjects(QList<QSharedPointer<QObject> > objects)
 
 void QpObjectListModelBase::objectInserted(QSharedPointer<QObject> object)
 {
+    invalidateTotalCount();
+
+    // The object may belong anywhere between the fetched rows
+    if (d->objectsFromDao && !d->isKeyOrdered()) {
+        resetObjects();
+        return;
+    }
+
     // fetches more items until the object is fetched
     indexForObjectBase(object);
 }
@@ -202,23 +454,24 @@ void QpObjectListModelBase::objectUpdated(QSharedPointer<QObject> object)
 
 void QpObjectListModelBase::objectRemoved(QSharedPointer<QObject> object)
 {
-    if (!d->rows.contains(object))
+    invalidateTotalCount();
+
+    int row = d->row(object);
+    if (row < 0)
         return;
 
-    int row = d->rows.value(object);
     beginRemoveRows(QModelIndex(), row, row);
 
-    for (int i = row + 1; i < d->objects.size(); ++i) {
-        d->rows.insert(d->objects.at(i), i - 1);
-    }
-    d->rows.remove(object);
     d->objects.removeAt(row);
+    d->keys.remove(row);
 
     endRemoveRows();
 }
 
 void QpObjectListModelBase::objectMarkedAsDeleted(QSharedPointer<QObject> object)
 {
+    invalidateTotalCount();
+
     objectUpdated(object);
 
     if (Qp::Private::isDeleted(object.data()))
@@ -227,18 +480,27 @@ void QpObjectListModelBase::objectMarkedAsDeleted(QSharedPointer<QObject> object
 
 void QpObjectListModelBase::objectUndeleted(QSharedPointer<QObject> object)
 {
-    if (!d->objectsFromDao || d->rows.contains(object))
+    if (!d->objectsFromDao || d->row(object) >= 0)
+        return;
+
+    invalidateTotalCount();
+
+    if (!d->isKeyOrdered()) {
+        resetObjects();
         return;
+    }
 
-    int index = d->dao->count(QpCondition::notDeletedAnd(d->condition)
-                              && QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, QpCondition::LessThan, Qp::Private::primaryKey(object.data())));
+    // Objects after the last fetched page will be fetched in their turn
+    int primaryKey = Qp::Private::primaryKey(object.data());
+    if (!d->lastKey.isValid() || primaryKey > d->lastKey.toInt())
+        return;
+
+    int index = d->insertionRow(primaryKey);
 
     beginInsertRows(QModelIndex(), index, index);
 
     d->objects.insert(index, object);
-    for (int i = index, c = d->objects.count(); i < c; ++i) {
-        d->rows.insert(d->objects.at(i), i);
-    }
+    d->keys.insert(index, primaryKey);
 
     endInsertRows();
 }
@@ -33,6 +33,19 @@ public:
     int fetchCount() const;
     void setFetchCount(int fetchCount);
 
+    enum CountMode {
+        ExactCount,       //! Counts the objects, which match the condition
+        ApproximateCount  //! Estimates the size of the whole table, fetches until a page comes back short
+    };
+    CountMode countMode() const;
+    void setCountMode(CountMode mode);
+    int totalCount() const;
+
+    bool isAsynchronous() const;
+    void setAsynchronous(bool asynchronous); //! fetchMore() reads in the datasource thread and inserts the rows, when the page has been read
+    bool isLoading() const;
+    QpError lastError() const; //! The error of the last asynchronous fetch, which has failed
+
     void setObjects(QList<QSharedPointer<QObject> > objectsBase);
 
     QList<QSharedPointer<QObject> > objectsBase() const Q_DECL_OVERRIDE;
@@ -42,6 +55,12 @@ public:
     QpDataAccessObjectBase *dataAccessObject() const;
 
     void setCondition(const QpCondition &condition);
+    QpCondition condition() const;
+    void setOrders(const QList<QpDatasource::OrderField> &orders);
+    QList<QpDatasource::OrderField> orders() const;
+
+signals:
+    void loadingChanged(bool loading);
 
 protected slots:
     void objectInserted(QSharedPointer<QObject>);
@@ -52,6 +71,14 @@ protected slots:
 
 private:
     QExplicitlySharedDataPointer<QpObjectListModelBaseData> d;
+
+    void invalidateTotalCount();
+    int itemsToFetch() const;
+    void fetchMoreSynchronously();
+    void appendObjects(const QList<QSharedPointer<QObject> > &objects, int requestedCount);
+    void cancelPendingFetch();
+    void resetObjects();
+    QList<QpDatasource::OrderField> ordersWithKey() const;
 };
 
 template<class T>
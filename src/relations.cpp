@@ -372,6 +372,29 @@ void QpRelationToOneBase::setObject(const QSharedPointer<QObject> newObject)
     d->setObject(newObject);
 }
 
+bool QpRelationToOneBase::isResolved() const
+{
+    Q_D(const QpRelationToOneBase);
+    return d->fk <= 0 || d->object();
+}
+
+/*!
+ * Sets the object, which has been read for the current foreign key, without
+ * touching the reverse relation. Used to resolve many relations in one batch.
+ */
+void QpRelationToOneBase::setResolvedObject(QSharedPointer<QObject> object)
+{
+    Q_D(QpRelationToOneBase);
+    Q_ASSERT(object);
+    Q_ASSERT(Qp::Private::primaryKey(object.data()) == d->fk);
+
+    if (d->object() == object)
+        return;
+
+    d->setObject(object);
+    d->initDependencies(object);
+}
+
 int QpRelationToOneBase::foreignKey() const
 {
     Q_D(const QpRelationToOneBase);
@@ -59,6 +59,9 @@ public:
     QSharedPointer<QObject> object() const;
     void setObject(const QSharedPointer<QObject> newObject);
 
+    bool isResolved() const;
+    void setResolvedObject(QSharedPointer<QObject> object);
+
     int foreignKey() const;
     void adjustFromDataTransferObject(const QpDataTransferObject &dataTransferObject) Q_DECL_OVERRIDE;
 };
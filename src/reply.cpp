@@ -1,4 +1,5 @@
 #include "datasourceresult.h"
+#include "error.h"
 #include "reply.h"
 
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
@@ -13,6 +14,7 @@ public:
 
     QpDatasourceResult *result;
     QList<QSharedPointer<QObject> > objects;
+    QpError error;
     bool finished;
 };
 
@@ -37,6 +39,14 @@ QList<QSharedPointer<QObject> > QpReply::objects() const
     return data->objects;
 }
 
+/*!
+ * A reply, which has failed, finishes without objects and reports the error here.
+ */
+QpError QpReply::lastError() const
+{
+    return data->error;
+}
+
 bool QpReply::isFinished() const
 {
     return data->finished;
@@ -61,6 +71,11 @@ void QpReply::setObjects(const QList<QSharedPointer<QObject> > &objects)
     data->objects = objects;
 }
 
+void QpReply::setLastError(const QpError &error)
+{
+    data->error = error;
+}
+
 void QpReply::setInternalResult(QpDatasourceResult *result)
 {
     data->result = result;
@@ -18,6 +18,7 @@ public:
     ~QpReply();
 
     QList<QSharedPointer<QObject> > objects() const;
+    QpError lastError() const;
 
     bool isFinished() const;
 
@@ -29,6 +30,7 @@ private slots:
 
     void finish();
     void setObjects(const QList<QSharedPointer<QObject> > &objects);
+    void setLastError(const QpError &error);
     void setInternalResult(QpDatasourceResult *result);
 
 private:
@@ -0,0 +1,36 @@
+#include "session.h"
+
+#include "defaultstorage.h"
+#include "storage.h"
+
+QpSession::QpSession(QpStorage *storage) :
+    m_storage(storage ? storage : Qp::defaultStorage()),
+    m_open(true)
+{
+    m_storage->startBulkDatabaseQueries();
+}
+
+QpSession::~QpSession()
+{
+    if (m_open)
+        rollback();
+}
+
+bool QpSession::isOpen() const
+{
+    return m_open;
+}
+
+bool QpSession::commit()
+{
+    Q_ASSERT(m_open);
+    m_open = false;
+    return m_storage->commitBulkDatabaseQueries();
+}
+
+void QpSession::rollback()
+{
+    Q_ASSERT(m_open);
+    m_open = false;
+    m_storage->rollbackBulkDatabaseQueries();
+}
@@ -0,0 +1,39 @@
+#ifndef QPERSISTENCE_SESSION_H
+#define QPERSISTENCE_SESSION_H
+
+#include "defines.h"
+BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QtCore/QtGlobal>
+END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+
+class QpStorage;
+
+/*!
+ * \brief The QpSession class is a unit of work for one logical operation.
+ * While a session is open, updates and removals of the storage's objects are
+ * only recorded. commit() writes the net change of every touched object once
+ * and in one transaction, and the data access objects emit one signal per
+ * object afterwards. A session, which has not been committed, is rolled back
+ * when it is destroyed. Sessions may be nested.
+ *
+ * Objects are still inserted immediately, because they need their primary key.
+ */
+class QpSession
+{
+public:
+    explicit QpSession(QpStorage *storage = nullptr); //! Opens a session for the default storage, if storage is null.
+    ~QpSession();
+
+    bool isOpen() const;
+
+    bool commit();
+    void rollback(); //! Drops the recorded writes. The objects keep their changed properties.
+
+private:
+    Q_DISABLE_COPY(QpSession)
+
+    QpStorage *m_storage;
+    bool m_open;
+};
+
+#endif // QPERSISTENCE_SESSION_H
@@ -4,7 +4,8 @@
 
 QpSortFilterProxyObjectModelBase::QpSortFilterProxyObjectModelBase(QObject *parent) :
     QSortFilterProxyModel(parent),
-    m_includeDeletedObjects(false)
+    m_includeDeletedObjects(false),
+    m_sortingAndFilteringInDatabase(false)
 {
     setSortCaseSensitivity(Qt::CaseInsensitive);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
@@ -40,6 +41,93 @@ void QpSortFilterProxyObjectModelBase::setIncludeDeletedObjects(bool includeDele
     m_includeDeletedObjects = includeDeletedObjects;
 }
 
+bool QpSortFilterProxyObjectModelBase::isSortingAndFilteringInDatabase() const
+{
+    return m_sortingAndFilteringInDatabase;
+}
+
+/*!
+ * Lets the source QpObjectListModel sort and filter in SQL, so that only the
+ * visible pages have to be fetched instead of the whole table. The proxy then
+ * owns the order of the source model and restricts its condition further by
+ * filterCondition(). Disabling restores the previous order and condition.
+ */
+void QpSortFilterProxyObjectModelBase::setSortingAndFilteringInDatabase(bool enabled)
+{
+    if (m_sortingAndFilteringInDatabase == enabled)
+        return;
+
+    m_sortingAndFilteringInDatabase = enabled;
+
+    QpObjectListModelBase *source = sourceObjectListModel();
+    if (!source)
+        return;
+
+    if (enabled) {
+        m_sourceCondition = source->condition();
+        m_sourceOrders = source->orders();
+        source->setCondition(databaseCondition());
+    }
+    else {
+        source->setCondition(m_sourceCondition);
+        source->setOrders(m_sourceOrders);
+        m_sourceCondition = QpCondition();
+        m_sourceOrders.clear();
+    }
+}
+
+/*!
+ * Call this, when filterCondition() has changed.
+ */
+void QpSortFilterProxyObjectModelBase::invalidateFilterCondition()
+{
+    QpObjectListModelBase *source = sourceObjectListModel();
+    if (m_sortingAndFilteringInDatabase && source)
+        source->setCondition(databaseCondition());
+
+    invalidateFilter();
+}
+
+void QpSortFilterProxyObjectModelBase::sort(int column, Qt::SortOrder order)
+{
+    QpObjectListModelBase *source = sourceObjectListModel();
+    QString field = sortRoleColumn(sortRole());
+    if (!m_sortingAndFilteringInDatabase || !source || column < 0 || field.isEmpty()) {
+        QSortFilterProxyModel::sort(column, order);
+        return;
+    }
+
+    QpDatasource::OrderField orderField;
+    orderField.field = field;
+    orderField.order = order == Qt::AscendingOrder ? QpDatasource::Ascending : QpDatasource::Descending;
+    source->setOrders(QList<QpDatasource::OrderField>() << orderField);
+
+    // Keep the order of the source model
+    QSortFilterProxyModel::sort(-1, order);
+}
+
+QString QpSortFilterProxyObjectModelBase::sortRoleColumn(int sortRole) const
+{
+    Q_UNUSED(sortRole);
+    return QString();
+}
+
+QpCondition QpSortFilterProxyObjectModelBase::filterCondition() const
+{
+    return QpCondition();
+}
+
+QpObjectListModelBase *QpSortFilterProxyObjectModelBase::sourceObjectListModel() const
+{
+    return qobject_cast<QpObjectListModelBase *>(sourceModel());
+}
+
+QpCondition QpSortFilterProxyObjectModelBase::databaseCondition() const
+{
+    QpCondition condition = m_sourceCondition;
+    return condition && filterCondition();
+}
+
 QList<QSharedPointer<QObject> > QpSortFilterProxyObjectModelBase::objectsBase() const
 {
     QList<QSharedPointer<QObject> > result;
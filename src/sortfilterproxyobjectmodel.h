@@ -23,6 +23,12 @@ public:
     bool includeDeletedObjects() const;
     void setIncludeDeletedObjects(bool includeDeletedObjects);
 
+    bool isSortingAndFilteringInDatabase() const;
+    void setSortingAndFilteringInDatabase(bool enabled);
+    void invalidateFilterCondition();
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_OVERRIDE;
+
     QList<QSharedPointer<QObject> > objectsBase() const Q_DECL_OVERRIDE;
 
 protected:
@@ -31,8 +37,21 @@ protected:
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const Q_DECL_OVERRIDE;
     virtual bool filterAcceptsObjectBase(QSharedPointer<QObject> object) const = 0;
 
+    // With sorting and filtering in the database, the source model reads its objects
+    // ordered by this column and matching this condition. Sort roles without a column
+    // are sorted and filterAcceptsObject() is applied locally, as without it.
+    virtual QString sortRoleColumn(int sortRole) const;
+    virtual QpCondition filterCondition() const;
+
 private:
     bool m_includeDeletedObjects;
+    bool m_sortingAndFilteringInDatabase;
+    // The order and condition of the source model, before the proxy has taken them over
+    QpCondition m_sourceCondition;
+    QList<QpDatasource::OrderField> m_sourceOrders;
+
+    QpObjectListModelBase *sourceObjectListModel() const;
+    QpCondition databaseCondition() const;
 };
 
 template<class T>
@@ -257,6 +257,12 @@ QString QpSqliteBackend::orIgnore() const
     return QLatin1String("OR IGNORE");
 }
 
+int QpSqliteBackend::maximumBindValueCount() const
+{
+    // SQLITE_MAX_VARIABLE_NUMBER defaults to 999 in builds before 3.32
+    return 999;
+}
+
 QString QpMySqlBackend::nowTimestamp() const
 {
     return QLatin1String("NOW(6) + 0");
@@ -266,3 +272,8 @@ QString QpMySqlBackend::orIgnore() const
 {
     return QLatin1String("IGNORE");
 }
+
+int QpMySqlBackend::maximumBindValueCount() const
+{
+    return 65535;
+}
@@ -22,6 +22,7 @@ public:
     virtual QString variantTypeToSqlType(QVariant::Type type) const = 0;
     virtual QString nowTimestamp() const = 0;
     virtual QString orIgnore() const = 0;
+    virtual int maximumBindValueCount() const = 0; //! The maximum number of placeholders in one statement
 };
 
 class QpSqliteBackend : public QpSqlBackend
@@ -33,6 +34,7 @@ public:
     QString variantTypeToSqlType(QVariant::Type type) const Q_DECL_OVERRIDE;
     QString nowTimestamp() const Q_DECL_OVERRIDE;
     QString orIgnore() const Q_DECL_OVERRIDE;
+    int maximumBindValueCount() const Q_DECL_OVERRIDE;
 };
 
 class QpMySqlBackend : public QpSqlBackend
@@ -44,6 +46,7 @@ public:
     QString variantTypeToSqlType(QVariant::Type type) const Q_DECL_OVERRIDE;
     QString nowTimestamp() const Q_DECL_OVERRIDE;
     QString orIgnore() const Q_DECL_OVERRIDE;
+    int maximumBindValueCount() const Q_DECL_OVERRIDE;
 };
 
 #endif // QPERSISTENCE_SQLBACKEND_H
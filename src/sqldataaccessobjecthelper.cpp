@@ -2,6 +2,7 @@
 
 #include "dataaccessobject.h"
 #include "databaseschema.h"
+#include "datasourceresult.h"
 #include "error.h"
 #include "metaobject.h"
 #include "metaproperty.h"
@@ -189,6 +190,15 @@ bool QpSqlDataAccessObjectHelper::updateObject(const QpMetaObject &metaObject, Q
 {
     Q_ASSERT(object);
 
+    // Objects, which have been read from the database before, only write their changed columns
+    bool hasSnapshot = !QpDataTransferObject::fromObject(object).isEmpty();
+    QpDataTransferObject changes;
+    if (hasSnapshot) {
+        changes = QpDataTransferObject::changesInObject(object);
+        if (!changes.hasChanges())
+            return true;
+    }
+
     if (!data->storage->beginTransaction())
         return false;
 
@@ -198,9 +208,26 @@ bool QpSqlDataAccessObjectHelper::updateObject(const QpMetaObject &metaObject, Q
     query.setWhereCondition(QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
                                            QpCondition::EqualTo,
                                            Qp::Private::primaryKey(object)));
-    fillValuesIntoQuery(metaObject, object, query);
-
-    query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, Qp::Private::isDeleted(object));
+    QList<QpMetaProperty> relations;
+    if (hasSnapshot) {
+        fillValuesIntoQuery(metaObject, object, query, &changes);
+        if (changes.dynamicProperties.contains(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG))
+            query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, Qp::Private::isDeleted(object));
+
+        foreach (const QpMetaProperty relation, metaObject.relationProperties()) {
+            int propertyIndex = relation.metaProperty().propertyIndex();
+            if (changes.toOneRelationFKs.contains(propertyIndex)
+                || changes.toManyRelationFKsAdded.contains(propertyIndex)
+                || changes.toManyRelationFKsRemoved.contains(propertyIndex)) {
+                relations.append(relation);
+            }
+        }
+    }
+    else {
+        fillValuesIntoQuery(metaObject, object, query);
+        query.addField(QpDatabaseSchema::COLUMN_NAME_DELETEDFLAG, Qp::Private::isDeleted(object));
+        relations = metaObject.relationProperties();
+    }
 
 #ifndef QP_NO_TIMESTAMPS
     query.addRawField(QpDatabaseSchema::COLUMN_NAME_UPDATE_TIME, QpSqlBackend::forDatabase(data->storage->database())->nowTimestamp());
@@ -214,7 +241,7 @@ bool QpSqlDataAccessObjectHelper::updateObject(const QpMetaObject &metaObject, Q
     }
 
     // Update related objects
-    adjustRelationsInDatabase(metaObject, object);
+    adjustRelationsInDatabase(relations, object);
 
     int revision = objectRevision(object);
     object->setProperty(QpDatabaseSchema::COLUMN_NAME_REVISION, revision);
@@ -224,10 +251,14 @@ bool QpSqlDataAccessObjectHelper::updateObject(const QpMetaObject &metaObject, Q
 
 void QpSqlDataAccessObjectHelper::fillValuesIntoQuery(const QpMetaObject &metaObject,
                                                       const QObject *object,
-                                                      QpSqlQuery &query)
+                                                      QpSqlQuery &query,
+                                                      const QpDataTransferObject *changes)
 {
     // Add simple properties
     foreach (const QpMetaProperty property, metaObject.simpleProperties()) {
+        if (changes && !changes->properties.contains(property.metaProperty().propertyIndex()))
+            continue;
+
         QVariant value = property.metaProperty().read(object);
         if (value == QVariant(0)
             && (property.metaProperty().isEnumType()
@@ -391,11 +422,11 @@ void QpSqlDataAccessObjectHelper::readQueryIntoObject(const QpSqlQuery &query,
     }
 }
 
-bool QpSqlDataAccessObjectHelper::adjustRelationsInDatabase(const QpMetaObject &metaObject, QObject *object)
+bool QpSqlDataAccessObjectHelper::adjustRelationsInDatabase(const QList<QpMetaProperty> &relations, QObject *object)
 {
     QList<QpSqlQuery> queries;
 
-    foreach (const QpMetaProperty property, metaObject.relationProperties()) {
+    foreach (const QpMetaProperty property, relations) {
         QpMetaProperty::Cardinality cardinality = property.cardinality();
 
         if (cardinality == QpMetaProperty::OneToOneCardinality) {
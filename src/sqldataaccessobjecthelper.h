@@ -14,6 +14,7 @@ class QSqlQuery;
 class QpMetaObject;
 class QpMetaProperty;
 class QpCondition;
+class QpDataTransferObject;
 class QpSqlQuery;
 class QpStorage;
 
@@ -56,12 +57,13 @@ private:
 
     void fillValuesIntoQuery(const QpMetaObject &metaObject,
                              const QObject *object,
-                             QpSqlQuery &query);
+                             QpSqlQuery &query,
+                             const QpDataTransferObject *changes = 0);
 
     void selectFields(const QpMetaObject &metaObject,
                       QpSqlQuery &query);
 
-    bool adjustRelationsInDatabase(const QpMetaObject &metaObject, QObject *object);
+    bool adjustRelationsInDatabase(const QList<QpMetaProperty> &relations, QObject *object);
 
     QpSqlQuery queryForForeignKeys(const QpMetaProperty &relation);
 
@@ -8,20 +8,176 @@
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 #include <QBuffer>
 #include <QByteArray>
+#include <QCache>
 #include <QDebug>
 #include <QHash>
 #include <QMetaProperty>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRegularExpressionMatchIterator>
 #include <QSharedData>
 #include <QSqlDriver>
+#include <QSqlError>
 #include <QSqlRecord>
 #include <QStringList>
+#include <QThreadStorage>
 #ifndef QP_NO_GUI
 #   include <QPixmap>
 #endif
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 
 
+/******************************************************************************
+ * QpSqlOrderedHash
+ */
+// A hash, which remembers the order in which its keys have been inserted.
+// Generating SQL from it yields the same text for the same sequence of calls,
+// which is what makes the prepared statements cacheable.
+template<class T>
+class QpSqlOrderedHash
+{
+public:
+    void insert(const QString &key, const T &value)
+    {
+        if (!m_values.contains(key))
+            m_keys.append(key);
+        m_values.insert(key, value);
+    }
+
+    T value(const QString &key) const { return m_values.value(key); }
+    QStringList keys() const { return m_keys; }
+    QList<T> values() const
+    {
+        QList<T> result;
+        result.reserve(m_keys.size());
+        foreach (const QString &key, m_keys) {
+            result.append(m_values.value(key));
+        }
+        return result;
+    }
+
+    bool isEmpty() const { return m_keys.isEmpty(); }
+    int size() const { return m_keys.size(); }
+    void clear()
+    {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+private:
+    QStringList m_keys;
+    QHash<QString, T> m_values;
+};
+
+
+/******************************************************************************
+ * QpSqlStatementCache
+ */
+// The prepared statements of one database connection, keyed by their SQL.
+// A statement is taken out of the cache while a query uses it, so that no
+// two queries ever bind values to the same statement.
+class QpSqlStatementCache
+{
+public:
+    QpSqlStatementCache() :
+        generation(++lastGeneration)
+    {
+    }
+
+    QCache<QString, QSqlQuery> statements;
+    // Unique for every cache, even for a new cache of a connection with the same name.
+    // Statements, which have been checked out of another cache, must not be returned into this one.
+    int generation;
+
+    static int lastGeneration;
+};
+
+int QpSqlStatementCache::lastGeneration = 0;
+
+typedef QHash<QString, QpSqlStatementCache *> HashStringToStatementCache;
+QP_DEFINE_STATIC_LOCAL(HashStringToStatementCache, StatementCaches)
+QP_DEFINE_STATIC_LOCAL(QMutex, StatementCachesMutex)
+
+
+/******************************************************************************
+ * QpSqlBulkQueue
+ */
+// The writing statements, which have been executed between QpSqlQuery::startBulkExec()
+// and QpSqlQuery::bulkExec() in one thread. Consecutive executions of the same statement
+// are collected in one batch, whose bind values are kept by placeholder.
+class QpSqlBulkQueue
+{
+public:
+    QpSqlBulkQueue() :
+        level(0)
+    {
+    }
+
+    struct Batch {
+        QSqlDatabase database;
+        QString statement;
+        QList<QVariantList> columns;
+        int rowCount;
+    };
+
+    int level;
+    QList<Batch> batches;
+
+    void enqueue(const QSqlDatabase &database, const QString &statement, const QVariantList &values);
+    void clear();
+};
+
+void QpSqlBulkQueue::enqueue(const QSqlDatabase &database, const QString &statement, const QVariantList &values)
+{
+    // A different statement starts a new batch, so that no statement is executed before an earlier one
+    if (batches.isEmpty()
+        || batches.last().statement != statement
+        || batches.last().database.connectionName() != database.connectionName()) {
+        Batch batch;
+        batch.database = database;
+        batch.statement = statement;
+        batch.rowCount = 0;
+        for (int i = 0; i < values.size(); ++i) {
+            batch.columns.append(QVariantList());
+        }
+        batches.append(batch);
+    }
+
+    Batch &batch = batches.last();
+    Q_ASSERT(batch.columns.size() == values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        batch.columns[i].append(values.at(i));
+    }
+    ++batch.rowCount;
+}
+
+void QpSqlBulkQueue::clear()
+{
+    batches.clear();
+}
+
+typedef QThreadStorage<QpSqlBulkQueue *> ThreadStorageBulkQueue;
+QP_DEFINE_STATIC_LOCAL(ThreadStorageBulkQueue, BulkQueues)
+
+static QpSqlBulkQueue *activeBulkQueue()
+{
+    if (!BulkQueues()->hasLocalData())
+        return nullptr;
+
+    QpSqlBulkQueue *queue = BulkQueues()->localData();
+    return queue->level > 0 ? queue : nullptr;
+}
+
+// Only statements, which do not return anything, can be deferred
+static bool isBulkStatement(const QString &query)
+{
+    QString statement = query.trimmed();
+    return statement.startsWith(QLatin1String("INSERT"), Qt::CaseInsensitive)
+           || statement.startsWith(QLatin1String("UPDATE"), Qt::CaseInsensitive)
+           || statement.startsWith(QLatin1String("DELETE"), Qt::CaseInsensitive);
+}
+
+
 /******************************************************************************
  * QpSqlQueryData
  */
@@ -32,10 +188,18 @@ public:
         limit(-1),
         skip(-1),
         ignore(false),
-        forUpdate(false)
+        forUpdate(false),
+        statement(nullptr),
+        statementGeneration(0),
+        statementExecuted(false)
     {
     }
 
+    ~QpSqlQueryData()
+    {
+        checkInStatement();
+    }
+
     struct Join {
         QString direction;
         QString table;
@@ -47,27 +211,76 @@ public:
     QpSqlBackend *backend;
     QString table;
     QString tableName;
-    QHash<QString, QVariant> fields;
+    QpSqlOrderedHash<QVariant> fields;
     // inserted directly into query instead of using bindValue
-    QHash<QString, QString> rawFields;
+    QpSqlOrderedHash<QString> rawFields;
+    // rows of a multi-row INSERT, which replace the fields
+    QList<QHash<QString, QVariant> > insertRows;
     QpCondition whereCondition;
     QList<QPair<QString, QpSqlQuery::Order> > orderBy;
     QList<QStringList> foreignKeys;
-    QHash<QString, QStringList> keys;
+    QpSqlOrderedHash<QStringList> keys;
     QHash<int, int> propertyIndexes;
     QStringList groups;
     int skip;
     bool ignore;
     bool forUpdate;
     QList<Join> joins;
+    // replaces the generated SELECT ... FROM ... JOIN part
+    QString selectClause;
+
+    // The statement, which has been checked out of the statement cache
+    QSqlQuery *statement;
+    QString statementKey;
+    int statementGeneration;
+    bool statementExecuted;
+
+    // A statement, which is deferred until QpSqlQuery::bulkExec(), and its bind values
+    QString bulkStatement;
+    QVariantList bulkValues;
 
     static bool debugEnabled;
+    static int statementCacheSize;
 
+    QString constructSelectClause() const;
     QString constructSelectQuery() const;
+    QString constructUpdateQuery() const;
+    QString constructInsertQuery() const;
+    QString constructDeleteQuery() const;
     QString escapedQualifiedField(const QString &field) const;
+    void checkInStatement();
 };
 
 bool QpSqlQueryData::debugEnabled = false;
+int QpSqlQueryData::statementCacheSize = 64;
+
+void QpSqlQueryData::checkInStatement()
+{
+    if (!statement)
+        return;
+
+    QSqlQuery *s = statement;
+    QString key = statementKey;
+    statement = nullptr;
+    statementKey = QString();
+
+    // Statements, which have never been executed, might still hold half of their bind values
+    if (!statementExecuted || statementCacheSize <= 0) {
+        delete s;
+        return;
+    }
+
+    s->finish();
+
+    QMutexLocker locker(StatementCachesMutex());
+    QpSqlStatementCache *cache = StatementCaches()->value(database.connectionName());
+    if (!cache || cache->generation != statementGeneration) {
+        delete s;
+        return;
+    }
+
+    cache->statements.insert(key, s);
+}
 
 
 /******************************************************************************
@@ -111,10 +324,29 @@ bool QpSqlQuery::exec(const QString &queryString)
 {
     bool ok = true;
     QString query = queryString;
+    if (query.isEmpty() && !data->bulkStatement.isEmpty()) {
+        QpSqlBulkQueue *queue = activeBulkQueue();
+        if (queue) {
+            queue->enqueue(data->database, data->bulkStatement, data->bulkValues);
+            data->bulkValues.clear();
+            return true;
+        }
+
+        // The bulk execution has ended before this query has been executed
+        QVariantList values = data->bulkValues;
+        if (!prepareStatement(data->bulkStatement))
+            return false;
+        foreach (const QVariant &value, values) {
+            QSqlQuery::addBindValue(value);
+        }
+    }
+
     if (query.isEmpty()) {
         ok = QSqlQuery::exec();
+        data->statementExecuted = true;
     }
     else {
+        releaseStatement();
         ok = QSqlQuery::exec(queryString);
     }
 
@@ -151,12 +383,30 @@ QString QpSqlQuery::table() const
     return data->table;
 }
 
+bool QpSqlQuery::prepare(const QString &query)
+{
+    releaseStatement();
+    data->bulkValues.clear();
+    data->bulkStatement = QString();
+
+    if (activeBulkQueue() && isBulkStatement(query)) {
+        data->bulkStatement = query;
+        return true;
+    }
+
+    return QSqlQuery::prepare(query);
+}
+
 void QpSqlQuery::clear()
 {
     QSqlQuery::clear();
+    data->checkInStatement();
+    data->bulkStatement = QString();
+    data->bulkValues.clear();
 
     data->table = QString();
     data->fields.clear();
+    data->insertRows.clear();
     data->limit = -1;
     data->skip = -1;
     data->whereCondition = QpCondition();
@@ -167,6 +417,7 @@ void QpSqlQuery::clear()
     data->ignore = false;
     data->forUpdate = false;
     data->propertyIndexes.clear();
+    data->selectClause = QString();
 }
 
 bool QpSqlQuery::isDebugEnabled()
@@ -179,6 +430,164 @@ void QpSqlQuery::setDebugEnabled(bool value)
     QpSqlQueryData::debugEnabled = value;
 }
 
+int QpSqlQuery::statementCacheSize()
+{
+    return QpSqlQueryData::statementCacheSize;
+}
+
+void QpSqlQuery::setStatementCacheSize(int size)
+{
+    QMutexLocker locker(StatementCachesMutex());
+    QpSqlQueryData::statementCacheSize = size;
+    foreach (QpSqlStatementCache *cache, *StatementCaches()) {
+        cache->statements.setMaxCost(qMax(0, size));
+    }
+}
+
+/*!
+ * Deletes the cached statements of \a database, e.g. because the schema has
+ * changed. The next query creates a new cache for the connection.
+ */
+void QpSqlQuery::clearStatementCache(const QSqlDatabase &database)
+{
+    removeStatementCache(database);
+}
+
+/*!
+ * Deletes the statement cache of \a database, which has to be called before the
+ * connection is closed or removed, so that no prepared statement outlives it.
+ * Statements, which queries are still using, are deleted, when they are returned.
+ */
+void QpSqlQuery::removeStatementCache(const QSqlDatabase &database)
+{
+    QMutexLocker locker(StatementCachesMutex());
+    delete StatementCaches()->take(database.connectionName());
+}
+
+/*!
+ * Defers all INSERT, UPDATE and DELETE statements, which are prepared in the
+ * current thread, until bulkExec() is called.
+ * exec() returns true for these statements without executing them. Calls
+ * may be nested.
+ */
+void QpSqlQuery::startBulkExec()
+{
+    if (!BulkQueues()->hasLocalData())
+        BulkQueues()->setLocalData(new QpSqlBulkQueue);
+
+    ++BulkQueues()->localData()->level;
+}
+
+/*!
+ * Executes the statements, which have been deferred since startBulkExec().
+ * Consecutive executions of the same SQL are bound and executed as one batch.
+ * The statements run in the order of their execution, so that a statement
+ * never overtakes one, on whose effect it might depend.
+ *
+ * Returns the error of the first failing batch. The statements after it are
+ * not executed.
+ */
+QSqlError QpSqlQuery::bulkExec()
+{
+    if (!BulkQueues()->hasLocalData())
+        return QSqlError();
+
+    QpSqlBulkQueue *queue = BulkQueues()->localData();
+    Q_ASSERT(queue->level > 0);
+    if (--queue->level > 0)
+        return QSqlError();
+
+    QList<QpSqlBulkQueue::Batch> batches = queue->batches;
+    queue->clear();
+
+    foreach (const QpSqlBulkQueue::Batch &batch, batches) {
+        QpSqlQuery query(batch.database);
+        if (!query.prepareStatement(batch.statement))
+            return query.lastError();
+
+        bool ok = true;
+        if (batch.columns.isEmpty()) {
+            for (int i = 0; ok && i < batch.rowCount; ++i) {
+                ok = query.QSqlQuery::exec();
+            }
+        }
+        else {
+            foreach (const QVariantList &column, batch.columns) {
+                query.QSqlQuery::addBindValue(column);
+            }
+            ok = query.execBatch();
+        }
+        query.data->statementExecuted = true;
+
+        if (QpSqlQueryData::debugEnabled)
+            qDebug() << qPrintable(QString("%1\n%2 times in a batch.").arg(batch.statement).arg(batch.rowCount));
+
+        if (!ok)
+            return query.lastError();
+    }
+
+    return QSqlError();
+}
+
+void QpSqlQuery::releaseStatement()
+{
+    if (!data->statement)
+        return;
+
+    data->checkInStatement();
+
+    // Detach from the statement, which might now be used by another query
+    QSqlQuery::operator=(QSqlQuery(data->database));
+}
+
+bool QpSqlQuery::prepareStatement(const QString &query)
+{
+    releaseStatement();
+    data->statementExecuted = false;
+    data->bulkValues.clear();
+    data->bulkStatement = QString();
+
+    // Between startBulkExec() and bulkExec() the statement is prepared only once for all executions
+    if (activeBulkQueue() && isBulkStatement(query)) {
+        data->bulkStatement = query;
+        return true;
+    }
+
+    if (QpSqlQueryData::statementCacheSize <= 0
+        || !data->database.isValid())
+        return QSqlQuery::prepare(query);
+
+    QString key = query;
+    key.prepend(isForwardOnly() ? QLatin1String("F:") : QLatin1String("S:"));
+
+    {
+        QMutexLocker locker(StatementCachesMutex());
+        QString connectionName = data->database.connectionName();
+        QpSqlStatementCache *cache = StatementCaches()->value(connectionName);
+        if (!cache) {
+            cache = new QpSqlStatementCache;
+            cache->statements.setMaxCost(QpSqlQueryData::statementCacheSize);
+            StatementCaches()->insert(connectionName, cache);
+        }
+
+        data->statementGeneration = cache->generation;
+        QSqlQuery *cached = cache->statements.take(key);
+        if (cached) {
+            QSqlQuery::operator=(*cached);
+            data->statement = cached;
+            data->statementKey = key;
+            return true;
+        }
+    }
+
+    if (!QSqlQuery::prepare(query))
+        return false;
+
+    data->statement = new QSqlQuery(*this);
+    data->statementKey = key;
+    return true;
+}
+
 QString QpSqlQueryData::escapedQualifiedField(const QString &field) const
 {
     QString t = tableName.isEmpty() ? table : tableName;
@@ -259,6 +668,13 @@ void QpSqlQuery::addField(const QString &name, const QVariant &value)
     data->fields.insert(name, value);
 }
 
+void QpSqlQuery::addInsertRow(const QHash<QString, QVariant> &values)
+{
+    Q_ASSERT(data->insertRows.isEmpty()
+             || data->insertRows.first().size() == values.size());
+    data->insertRows.append(values);
+}
+
 void QpSqlQuery::addForeignKey(const QString &columnName,
                                const QString &keyName,
                                const QString &foreignTableName,
@@ -332,12 +748,10 @@ void QpSqlQuery::prepareCreateTable()
     query.append(escapeField(data->table)).append(" (\n\t");
 
     QStringList fields;
-    QHashIterator<QString, QVariant> it(data->fields);
-    while (it.hasNext()) {
-        it.next();
+    foreach (const QString &field, data->fields.keys()) {
         fields.append(QString("%1 %2")
-                      .arg(escapeField(it.key()))
-                      .arg(it.value().toString()));
+                      .arg(escapeField(field))
+                      .arg(data->fields.value(field).toString()));
     }
     query.append(fields.join(",\n\t"));
 
@@ -380,7 +794,7 @@ void QpSqlQuery::prepareCreateTable()
 
     query.append("\n);");
 
-    QSqlQuery::prepare(query);
+    prepare(query);
 }
 
 void QpSqlQuery::prepareDropTable()
@@ -388,18 +802,18 @@ void QpSqlQuery::prepareDropTable()
     QString query("DROP TABLE ");
     query.append(escapeField(data->table)).append(";");
 
-    QSqlQuery::prepare(query);
+    prepare(query);
 }
 
 void QpSqlQuery::prepareAlterTable()
 {
-    QSqlQuery::prepare(QString("ALTER TABLE %1 ADD COLUMN %2 %3;")
-                       .arg(escapeField(data->table))
-                       .arg(escapeField(data->fields.keys().first()))
-                       .arg(data->fields.values().first().toString()));
+    prepare(QString("ALTER TABLE %1 ADD COLUMN %2 %3;")
+            .arg(escapeField(data->table))
+            .arg(escapeField(data->fields.keys().first()))
+            .arg(data->fields.values().first().toString()));
 }
 
-QString QpSqlQueryData::constructSelectQuery() const
+QString QpSqlQueryData::constructSelectClause() const
 {
     QString query("SELECT ");
 
@@ -429,6 +843,13 @@ QString QpSqlQueryData::constructSelectQuery() const
                      .arg(join.on));
     }
 
+    return query;
+}
+
+QString QpSqlQueryData::constructSelectQuery() const
+{
+    QString query = selectClause.isEmpty() ? constructSelectClause() : selectClause;
+
     if (whereCondition.isValid()) {
         query.append("\n\tWHERE ").append(whereCondition.toSqlClause());
     }
@@ -468,40 +889,79 @@ QString QpSqlQueryData::constructSelectQuery() const
     return query;
 }
 
+QString QpSqlQuery::selectClause() const
+{
+    return data->selectClause.isEmpty() ? data->constructSelectClause() : data->selectClause;
+}
+
+void QpSqlQuery::setSelectClause(const QString &clause)
+{
+    data->selectClause = clause;
+}
+
+QString QpSqlQuery::selectStatement() const
+{
+    return data->constructSelectQuery();
+}
+
+QString QpSqlQuery::updateStatement() const
+{
+    return data->constructUpdateQuery();
+}
+
+QString QpSqlQuery::insertStatement() const
+{
+    return data->constructInsertQuery();
+}
+
+QString QpSqlQuery::deleteStatement() const
+{
+    return data->constructDeleteQuery();
+}
+
 void QpSqlQuery::prepareSelect()
 {
-    QSqlQuery::prepare(data->constructSelectQuery());
+    prepareStatement(data->constructSelectQuery());
 
     foreach (const QVariant value, data->whereCondition.bindValues()) {
         addBindValue(value);
     }
 }
 
-bool QpSqlQuery::prepareUpdate()
+QString QpSqlQueryData::constructUpdateQuery() const
 {
-    if (data->fields.isEmpty()
-        && data->rawFields.isEmpty())
-        return false;
+    if (fields.isEmpty()
+        && rawFields.isEmpty())
+        return QString();
 
     QString query("UPDATE ");
-    query.append(escapeField(data->table)).append(" SET\n\t");
+    query.append(QpSqlQuery::escapeField(table)).append(" SET\n\t");
 
-    QStringList fields;
-    foreach (const QString &field, data->fields.keys()) {
-        fields.append(QString("%1 = ?").arg(escapeField(field)));
+    QStringList localFields;
+    foreach (const QString &field, fields.keys()) {
+        localFields.append(QString("%1 = ?").arg(QpSqlQuery::escapeField(field)));
     }
-    foreach (const QString &field, data->rawFields.keys()) {
-        fields.append(QString("%1 = %2")
-                      .arg(escapeField(field))
-                      .arg(data->rawFields.value(field)));
+    foreach (const QString &field, rawFields.keys()) {
+        localFields.append(QString("%1 = %2")
+                           .arg(QpSqlQuery::escapeField(field))
+                           .arg(rawFields.value(field)));
     }
-    query.append(fields.join(",\n\t"));
+    query.append(localFields.join(",\n\t"));
 
-    if (data->whereCondition.isValid()) {
-        query.append("\n\tWHERE ").append(data->whereCondition.toSqlClause());
+    if (whereCondition.isValid()) {
+        query.append("\n\tWHERE ").append(whereCondition.toSqlClause());
     }
 
-    QSqlQuery::prepare(query);
+    return query;
+}
+
+bool QpSqlQuery::prepareUpdate()
+{
+    QString query = data->constructUpdateQuery();
+    if (query.isEmpty())
+        return false;
+
+    prepareStatement(query);
 
     foreach (const QVariant value, data->fields.values()) {
         addBindValue(value);
@@ -513,67 +973,110 @@ bool QpSqlQuery::prepareUpdate()
     return true;
 }
 
-void QpSqlQuery::prepareInsert()
+// All rows of a multi-row INSERT share the columns of the first row.
+// They are sorted, because the order of a QHash is not deterministic.
+static QStringList insertFieldKeys(const QpSqlQueryData *data)
+{
+    if (data->insertRows.isEmpty())
+        return data->fields.keys();
+
+    QStringList fieldKeys = data->insertRows.first().keys();
+    fieldKeys.sort();
+    return fieldKeys;
+}
+
+QString QpSqlQueryData::constructInsertQuery() const
 {
     QString query("INSERT ");
-    if (data->ignore)
-        query.append(data->backend->orIgnore());
+    if (ignore)
+        query.append(backend->orIgnore());
 
     query.append(" INTO ");
 
-    query.append(escapeField(data->table)).append("\n\t(");
+    query.append(QpSqlQuery::escapeField(table)).append("\n\t(");
 
-    QStringList rawFieldKeys = data->rawFields.keys();
+    QStringList rawFieldKeys = rawFields.keys();
+    QStringList fieldKeys = insertFieldKeys(this);
 
-    QStringList fields;
-    foreach (const QString &field, data->fields.keys()) {
-        fields.append(QString("%1").arg(escapeField(field)));
+    QStringList localFields;
+    foreach (const QString &field, fieldKeys) {
+        localFields.append(QString("%1").arg(QpSqlQuery::escapeField(field)));
     }
     foreach (QString field, rawFieldKeys) {
-        fields.append(escapeField(field));
+        localFields.append(QpSqlQuery::escapeField(field));
     }
-    query.append(fields.join(", "));
+    query.append(localFields.join(", "));
 
-    query.append(")\n\tVALUES (");
-
-    fields = QStringList();
-    int s = data->fields.size();
+    localFields = QStringList();
+    int s = fieldKeys.size();
     for (int i = 0; i < s; ++i) {
-        fields.append(QLatin1String("?"));
+        localFields.append(QLatin1String("?"));
     }
     foreach (QString field, rawFieldKeys) {
-        fields.append(data->rawFields.value(field));
+        localFields.append(rawFields.value(field));
     }
+    QString row = QString("(%1)").arg(localFields.join(", "));
 
-    query.append(fields.join(", "));
-    query.append(") ");
+    query.append(")\n\tVALUES ");
+    if (insertRows.isEmpty()) {
+        query.append(row);
+    }
+    else {
+        QStringList rows;
+        rows.reserve(insertRows.size());
+        for (int i = 0; i < insertRows.size(); ++i) {
+            rows.append(row);
+        }
+        query.append(rows.join(",\n\t"));
+    }
+    query.append(" ");
 
-    if (data->whereCondition.isValid()) {
-        query.append("\n\tWHERE ").append(data->whereCondition.toSqlClause());
+    if (whereCondition.isValid()) {
+        query.append("\n\tWHERE ").append(whereCondition.toSqlClause());
     }
 
-    QSqlQuery::prepare(query);
+    return query;
+}
 
-    foreach (const QVariant value, data->fields.values()) {
-        addBindValue(value);
+void QpSqlQuery::prepareInsert()
+{
+    prepareStatement(data->constructInsertQuery());
+
+    QStringList fieldKeys = insertFieldKeys(data.data());
+    if (data->insertRows.isEmpty()) {
+        foreach (const QVariant value, data->fields.values()) {
+            addBindValue(value);
+        }
+    }
+    else {
+        foreach (const QHash<QString, QVariant> &values, data->insertRows) {
+            foreach (const QString &field, fieldKeys) {
+                addBindValue(values.value(field));
+            }
+        }
     }
     foreach (const QVariant value, data->whereCondition.bindValues()) {
         addBindValue(value);
     }
 }
 
-void QpSqlQuery::prepareDelete()
+QString QpSqlQueryData::constructDeleteQuery() const
 {
     QString query("DELETE FROM ");
-    query.append(escapeField(data->table));
+    query.append(QpSqlQuery::escapeField(table));
 
-    if (data->whereCondition.isValid()) {
+    if (whereCondition.isValid()) {
         query.append("\n\tWHERE ");
-        query.append(data->whereCondition.toSqlClause());
+        query.append(whereCondition.toSqlClause());
     }
 
     query.append(';');
-    QSqlQuery::prepare(query);
+    return query;
+}
+
+void QpSqlQuery::prepareDelete()
+{
+    prepareStatement(data->constructDeleteQuery());
 
     foreach (const QVariant value, data->whereCondition.bindValues()) {
         addBindValue(value);
@@ -595,7 +1098,7 @@ void QpSqlQuery::prepareincrementNumericColumn()
                  .arg(QpSqlBackend::forDatabase(data->database)->nowTimestamp()));
     query.append("\n\tWHERE ").append(data->whereCondition.toSqlClause());
 
-    QSqlQuery::prepare(query);
+    prepareStatement(query);
 
     foreach (const QVariant value, data->whereCondition.bindValues()) {
         addBindValue(value);
@@ -630,6 +1133,11 @@ QMetaProperty QpSqlQuery::propertyForIndex(const QSqlRecord &record, const QMeta
 
 void QpSqlQuery::addBindValue(const QVariant &val)
 {
+    if (!data->bulkStatement.isEmpty()) {
+        data->bulkValues.append(variantToSqlStorableVariant(val));
+        return;
+    }
+
     QSqlQuery::addBindValue(variantToSqlStorableVariant(val));
 }
 
@@ -5,6 +5,7 @@
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 #include <QtCore/QExplicitlySharedDataPointer>
 #include <QtCore/QVariant>
+#include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 
@@ -32,6 +33,7 @@ public:
 
     bool exec(const QString &queryString);
     bool exec();
+    bool prepare(const QString &query);
 
     QString table() const;
 
@@ -43,6 +45,7 @@ public:
     void setOrIgnore(bool ignore);
     void addRawField(const QString &name, const QString &value = QString());
     void addField(const QString &name, const QVariant &value = QVariant());
+    void addInsertRow(const QHash<QString, QVariant> &values);
     void addForeignKey(const QString &columnName,
                        const QString &keyName,
                        const QString &foreignTableName,
@@ -62,6 +65,20 @@ public:
     void prepareDropTable();
     void prepareAlterTable();
 
+    // The SQL, which the prepare methods below would prepare
+    QString selectStatement() const;
+    QString updateStatement() const;
+    QString insertStatement() const;
+    QString deleteStatement() const;
+
+    // The "SELECT ... FROM ... JOIN" part of selectStatement(), which can be
+    // replaced by one, which has been generated before
+    QString selectClause() const;
+    void setSelectClause(const QString &clause);
+
+    // Prepares a statement, which has been generated before, with the statement cache
+    bool prepareStatement(const QString &query);
+
     void prepareSelect();
     bool prepareUpdate();
     void prepareInsert();
@@ -77,8 +94,12 @@ public:
 
     static bool isDebugEnabled();
     static void setDebugEnabled(bool value);
-    static void bulkExec();
+    static int statementCacheSize();
+    static void setStatementCacheSize(int size);
+    static void clearStatementCache(const QSqlDatabase &database);
+    static void removeStatementCache(const QSqlDatabase &database);
     static void startBulkExec();
+    static QSqlError bulkExec();
 
     QString escapedQualifiedField(const QString &field) const;
 
@@ -88,6 +109,7 @@ public:
 private:
     QExplicitlySharedDataPointer<QpSqlQueryData> data;
 
+    void releaseStatement();
 };
 
 #endif // QPERSISTENCE_SQLQUERY_H
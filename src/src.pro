@@ -40,6 +40,7 @@ HEADERS += \
     cache.h \
     condition.h \
     conversion.h \
+    cursor.h \
     dataaccessobject.h \
     databaseschema.h \
     datasource.h \
@@ -59,6 +60,7 @@ HEADERS += \
     relations.h \
     reply.h \
     schemaversioning.h \
+    session.h \
     sortfilterproxyobjectmodel.h \
     sqlbackend.h \
     sqldataaccessobjecthelper.h \
@@ -72,6 +74,7 @@ SOURCES += \
     cache.cpp \
     condition.cpp \
     conversion.cpp \
+    cursor.cpp \
     dataaccessobject.cpp \
     databaseschema.cpp \
     datasource.cpp \
@@ -89,6 +92,7 @@ SOURCES += \
     relations.cpp \
     reply.cpp \
     schemaversioning.cpp \
+    session.cpp \
     sortfilterproxyobjectmodel.cpp \
     sqlbackend.cpp \
     sqldataaccessobjecthelper.cpp \
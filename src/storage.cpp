@@ -4,11 +4,13 @@
 #include "datasourceresult.h"
 #include "error.h"
 #include "propertydependencieshelper.h"
+#include "relations.h"
 #include "sqlbackend.h"
 #include "sqlquery.h"
 #include "transactionshelper.h"
 
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
+#include <QSet>
 #include <QSqlError>
 #include <QThread>
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
@@ -25,9 +27,14 @@ public:
     QpStorageData() :
         QSharedData(),
         locksEnabled(false),
+        optimisticConcurrencyEnabled(false),
+        materializedRevisionsEnabled(false),
         datasource(nullptr),
-        asynchronousDatasource(nullptr),
-        datasourceThread(nullptr)
+        asynchronousDatasourceCount(1),
+        bulkDatabaseQueriesLevel(0),
+        bulkDatabaseQueriesRolledBack(false),
+        incrementMode(QpStorage::TableMaximumIncrement),
+        sequenceBlockSize(20)
     {
     }
 
@@ -35,6 +42,8 @@ public:
 
     QpError lastError;
     bool locksEnabled;
+    bool optimisticConcurrencyEnabled;
+    bool materializedRevisionsEnabled;
     QHash<QSharedPointer<QObject>, QpLock> localLocks;
     QHash<QString, QVariant::Type> additionalLockFields;
     QHash<QString, QpDataAccessObjectBase *> dataAccessObjects;
@@ -42,8 +51,18 @@ public:
     QpTransactionsHelper *transactionsHelper;
     QpPropertyDependenciesHelper *propertyDependenciesHelper;
     QpDatasource *datasource;
-    QpDatasource *asynchronousDatasource;
-    QThread *datasourceThread;
+    int asynchronousDatasourceCount;
+    QList<QThread *> datasourceThreads;
+    QList<QpDatasource *> asynchronousDatasources;
+    // The number of results, which each asynchronous datasource has not finished yet
+    QHash<QpDatasource *, int> pendingResults;
+    // The datasource and the number of pending results of each ordered caller
+    QHash<const QObject *, QPair<QpDatasource *, int> > orderedResults;
+    QpCacheMemoryPool cacheMemoryPool;
+    int bulkDatabaseQueriesLevel;
+    bool bulkDatabaseQueriesRolledBack;
+    QpStorage::IncrementMode incrementMode;
+    int sequenceBlockSize;
 
     static QpStorage *defaultStorage;
 };
@@ -60,6 +79,7 @@ QpStorage::QpStorage(QObject *parent) :
     data->propertyDependenciesHelper = new QpPropertyDependenciesHelper(this);
 
     qRegisterMetaType<QpDataTransferObjectsById>();
+    qRegisterMetaType<QpDataTransferObjectList>();
     qRegisterMetaType<QpMetaObject>();
     qRegisterMetaType<QpCondition>();
     qRegisterMetaType<QList<QpDatasource::OrderField>>();
@@ -70,10 +90,88 @@ QpStorage::QpStorage(QObject *parent) :
 
 QpStorage::~QpStorage()
 {
+    stopAsynchronousDatasources();
     delete data->transactionsHelper;
     delete data->propertyDependenciesHelper;
 }
 
+QpCacheMemoryPool QpStorage::cacheMemoryPool() const
+{
+    return data->cacheMemoryPool;
+}
+
+QpCacheStatistics QpStorage::cacheStatistics() const
+{
+    // Data access objects are registered once for each class in their hierarchy
+    QList<QpDataAccessObjectBase *> daos;
+    QpCacheStatistics statistics;
+    foreach (QpDataAccessObjectBase *dao, data->dataAccessObjects) {
+        if (daos.contains(dao))
+            continue;
+
+        daos.append(dao);
+        statistics += dao->cache().statistics();
+    }
+    return statistics;
+}
+
+void QpStorage::resetCacheStatistics()
+{
+    foreach (QpDataAccessObjectBase *dao, data->dataAccessObjects) {
+        dao->cache().resetStatistics();
+    }
+}
+
+void QpStorage::enableOptimisticConcurrency()
+{
+    data->optimisticConcurrencyEnabled = true;
+}
+
+bool QpStorage::isOptimisticConcurrencyEnabled() const
+{
+    return data->optimisticConcurrencyEnabled;
+}
+
+/*!
+ * Stores the current revision and action of each object on its own row, where
+ * the history triggers maintain them, instead of looking them up in the history
+ * table with every read. Has to be called before adjustDatabaseSchema().
+ *
+ * The history triggers only exist for MySQL, so that this does nothing on SQLite.
+ */
+void QpStorage::enableMaterializedRevisions()
+{
+#ifdef QP_FOR_MYSQL
+    data->materializedRevisionsEnabled = true;
+#endif
+}
+
+bool QpStorage::isMaterializedRevisionsEnabled() const
+{
+    return data->materializedRevisionsEnabled;
+}
+
+QpStorage::IncrementMode QpStorage::incrementMode() const
+{
+    return data->incrementMode;
+}
+
+void QpStorage::setIncrementMode(QpStorage::IncrementMode mode)
+{
+    data->incrementMode = mode;
+}
+
+int QpStorage::sequenceBlockSize() const
+{
+    return data->sequenceBlockSize;
+}
+
+void QpStorage::setSequenceBlockSize(int size)
+{
+    Q_ASSERT(size > 0);
+    data->sequenceBlockSize = size;
+}
+
 QpPropertyDependenciesHelper *QpStorage::propertyDependenciesHelper() const
 {
     return data->propertyDependenciesHelper;
@@ -96,6 +194,8 @@ QpStorage *QpStorage::forObject(QSharedPointer<QObject> object)
 
 void QpStorage::registerDataAccessObject(QpDataAccessObjectBase *dao, const QMetaObject *objectInClassHierarchy)
 {
+    dao->cache().setMemoryPool(data->cacheMemoryPool);
+
     do {
         QString className = QpMetaObject::removeNamespaces(objectInClassHierarchy->className());
         data->dataAccessObjects.insert(objectInClassHierarchy->className(), dao);
@@ -107,6 +207,7 @@ void QpStorage::registerDataAccessObject(QpDataAccessObjectBase *dao, const QMet
 
 void QpStorage::setDatabase(const QSqlDatabase &database)
 {
+    QpSqlQuery::removeStatementCache(data->database);
     if (data->database.isOpen()) {
         data->database.close();
     }
@@ -197,6 +298,91 @@ bool QpStorage::rollbackTransaction()
     return data->transactionsHelper->rollback();
 }
 
+/*!
+ * Collects all updates and removals of objects until commitBulkDatabaseQueries()
+ * is called. An object, which is updated several times, is written only once with
+ * its last state. Inserts are not deferred, because new objects need their primary
+ * key immediately. Calls may be nested.
+ */
+void QpStorage::startBulkDatabaseQueries()
+{
+    ++data->bulkDatabaseQueriesLevel;
+}
+
+/*!
+ * Writes the collected updates and removals in one transaction, executing equal
+ * statements as batches. After the transaction has been committed, the objects
+ * receive their new revisions and their data access objects emit one signal per
+ * object. Returns false and drops the queries, if any nested scope has been
+ * rolled back.
+ */
+bool QpStorage::commitBulkDatabaseQueries()
+{
+    Q_ASSERT(data->bulkDatabaseQueriesLevel > 0);
+    if (--data->bulkDatabaseQueriesLevel > 0)
+        return !data->bulkDatabaseQueriesRolledBack;
+
+    QList<QpDataAccessObjectBase *> daos = bulkDataAccessObjects();
+    if (data->bulkDatabaseQueriesRolledBack || !beginTransaction()) {
+        rollbackBulkDatabaseQueries(daos);
+        return false;
+    }
+
+    // After an error the transaction is rolled back and the remaining queries are dropped
+    bool ok = true;
+    foreach (QpDataAccessObjectBase *dao, daos) {
+        ok = ok && dao->writeBulkDatabaseQueries();
+    }
+
+    if (!commitOrRollbackTransaction() || !ok) {
+        rollbackBulkDatabaseQueries(daos);
+        return false;
+    }
+
+    foreach (QpDataAccessObjectBase *dao, daos) {
+        dao->finishBulkDatabaseQueries();
+    }
+    return true;
+}
+
+/*!
+ * Drops the collected updates and removals. The objects keep their changed
+ * properties, but they are not written.
+ */
+void QpStorage::rollbackBulkDatabaseQueries()
+{
+    Q_ASSERT(data->bulkDatabaseQueriesLevel > 0);
+    data->bulkDatabaseQueriesRolledBack = true;
+    if (--data->bulkDatabaseQueriesLevel > 0)
+        return;
+
+    rollbackBulkDatabaseQueries(bulkDataAccessObjects());
+}
+
+void QpStorage::rollbackBulkDatabaseQueries(const QList<QpDataAccessObjectBase *> &daos)
+{
+    data->bulkDatabaseQueriesRolledBack = false;
+    foreach (QpDataAccessObjectBase *dao, daos) {
+        dao->clearBulkDatabaseQueries();
+    }
+}
+
+QList<QpDataAccessObjectBase *> QpStorage::bulkDataAccessObjects() const
+{
+    // Data access objects are registered once for each class in their hierarchy
+    QList<QpDataAccessObjectBase *> daos;
+    foreach (QpDataAccessObjectBase *dao, data->dataAccessObjects) {
+        if (!daos.contains(dao))
+            daos.append(dao);
+    }
+    return daos;
+}
+
+bool QpStorage::isBulkDatabaseQueriesStarted() const
+{
+    return data->bulkDatabaseQueriesLevel > 0;
+}
+
 void QpStorage::resetAllLastKnownSynchronizations()
 {
     foreach (QpDataAccessObjectBase *dao, data->dataAccessObjects.values()) {
@@ -210,17 +396,122 @@ QpDatasource *QpStorage::datasource() const
     return data->datasource;
 }
 
+/*!
+ * Tells all datasources, that tables or columns have changed, so that they
+ * drop what they have cached about the database schema.
+ */
+void QpStorage::databaseSchemaChanged()
+{
+    if (data->datasource)
+        data->datasource->clearSchemaCache();
+
+    foreach (QpDatasource *datasource, data->asynchronousDatasources) {
+        Q_ASSUME(QMetaObject::invokeMethod(datasource, "clearSchemaCache", Qt::QueuedConnection));
+    }
+}
+
 QpDatasource *QpStorage::asynchronousDatasource() const
 {
-    if(data->asynchronousDatasource)
-        return data->asynchronousDatasource;
+    startAsynchronousDatasources();
+    return data->asynchronousDatasources.first();
+}
+
+/*!
+ * Chooses the asynchronous datasource, which should execute \a result.
+ *
+ * The result goes to the datasource with the fewest pending results. Results,
+ * which are dispatched with the same \a orderedBy, are executed by the same
+ * datasource as long as one of them is pending, so that they finish in the
+ * order in which they have been dispatched.
+ */
+QpDatasource *QpStorage::asynchronousDatasource(QpDatasourceResult *result, const QObject *orderedBy) const
+{
+    startAsynchronousDatasources();
+
+    QpDatasource *datasource = nullptr;
+    auto ordered = data->orderedResults.find(orderedBy);
+    if (orderedBy && ordered != data->orderedResults.end()) {
+        datasource = ordered->first;
+        ++ordered->second;
+    }
+    else {
+        foreach (QpDatasource *d, data->asynchronousDatasources) {
+            if (!datasource || data->pendingResults.value(d) < data->pendingResults.value(datasource))
+                datasource = d;
+        }
+
+        if (orderedBy)
+            data->orderedResults.insert(orderedBy, qMakePair(datasource, 1));
+    }
+    ++data->pendingResults[datasource];
+
+    // Results are deleted by their receivers after they have finished or failed
+    connect(result, &QObject::destroyed, this, [this, datasource, orderedBy] {
+        auto pending = data->pendingResults.find(datasource);
+        if (pending != data->pendingResults.end())
+            --pending.value();
+
+        auto ordered = data->orderedResults.find(orderedBy);
+        if (orderedBy && ordered != data->orderedResults.end() && --ordered->second == 0)
+            data->orderedResults.erase(ordered);
+    });
+
+    return datasource;
+}
+
+int QpStorage::asynchronousDatasourceCount() const
+{
+    return data->asynchronousDatasourceCount;
+}
+
+/*!
+ * Sets the number of threads, which execute asynchronous datasource calls.
+ * Each of them opens its own database connection. Running threads are stopped
+ * and the new number is started with the next asynchronous call.
+ */
+void QpStorage::setAsynchronousDatasourceCount(int count)
+{
+    Q_ASSERT(count > 0);
+    if (count == data->asynchronousDatasourceCount)
+        return;
+
+    stopAsynchronousDatasources();
+    data->asynchronousDatasourceCount = count;
+}
+
+void QpStorage::startAsynchronousDatasources() const
+{
+    if (!data->asynchronousDatasources.isEmpty())
+        return;
 
     Q_ASSERT(data->datasource->features() & QpDatasource::Asynchronous);
-    data->datasourceThread = new QThread(const_cast<QpStorage *>(this));
-    data->datasourceThread->setObjectName("DatasourceThread");
-    data->asynchronousDatasource = datasource()->cloneForThread(data->datasourceThread);
-    data->datasourceThread->start();
-    return data->asynchronousDatasource;
+    for (int i = 0; i < data->asynchronousDatasourceCount; ++i) {
+        // The thread name makes the name of the cloned database connection unique
+        QThread *thread = new QThread(const_cast<QpStorage *>(this));
+        thread->setObjectName(QString::fromLatin1("DatasourceThread%1").arg(i));
+        data->datasourceThreads.append(thread);
+        data->asynchronousDatasources.append(datasource()->cloneForThread(thread));
+        thread->start();
+    }
+}
+
+void QpStorage::stopAsynchronousDatasources()
+{
+    for (int i = 0; i < data->asynchronousDatasources.size(); ++i) {
+        // Objects, which are deleted later, are deleted when their thread finishes. This way each
+        // datasource removes its database connection in its own thread, before the connection name
+        // might be used again by the next start.
+        QThread *thread = data->datasourceThreads.at(i);
+        data->asynchronousDatasources.at(i)->deleteLater();
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+
+    data->datasourceThreads.clear();
+    data->asynchronousDatasources.clear();
+    data->pendingResults.clear();
+    data->orderedResults.clear();
 }
 
 void QpStorage::setDatasource(QpDatasource *datasource)
@@ -228,13 +519,7 @@ void QpStorage::setDatasource(QpDatasource *datasource)
     if(data->datasource)
         data->datasource->deleteLater();
 
-    if(data->asynchronousDatasource) {
-        data->datasourceThread->quit();
-        data->datasourceThread->deleteLater();
-        data->asynchronousDatasource->deleteLater();
-        data->datasourceThread = nullptr;
-        data->asynchronousDatasource = nullptr;
-    }
+    stopAsynchronousDatasources();
 
     data->datasource = datasource;
 }
@@ -306,15 +591,165 @@ QpDataAccessObjectBase *QpStorage::dataAccessObject(QSharedPointer<QObject> obje
     return dataAccessObject(*object->metaObject());
 }
 
+/*!
+ * Resolves the relation \a relationName of all \a objects with a single read
+ * of the related objects, instead of one read per object on first access.
+ * Returns the related objects without duplicates.
+ */
+QList<QSharedPointer<QObject> > QpStorage::resolveRelation(const QList<QSharedPointer<QObject> > &objects, const QString &relationName)
+{
+    if (objects.isEmpty())
+        return objects;
+
+    QpMetaProperty relation = QpMetaObject::forObject(objects.first().data()).metaProperty(relationName);
+    Q_ASSERT_X(relation.isRelationProperty(), Q_FUNC_INFO,
+               qPrintable(QString("Only relations can be resolved, '%1' is not one.").arg(relationName)));
+
+    QList<QSharedPointer<QObject> > related;
+    QSet<int> relatedKeys;
+    QList<int> keys;
+    // Targets which are already resolved on some owners are re-used for the unresolved ones
+    QHash<int, QSharedPointer<QObject> > objectsByKey;
+    QList<QpRelationBase *> unresolved;
+    bool toOne = relation.isToOneRelationProperty();
+
+    foreach (QSharedPointer<QObject> object, objects) {
+        QpRelationBase *r = relation.internalRelationObject(object.data());
+
+        QList<int> fks;
+        if (toOne) {
+            QpRelationToOneBase *toOneRelation = static_cast<QpRelationToOneBase *>(r);
+            if (toOneRelation->foreignKey() <= 0)
+                continue;
+
+            if (toOneRelation->isResolved()) {
+                QSharedPointer<QObject> target = toOneRelation->object();
+                int fk = toOneRelation->foreignKey();
+                objectsByKey.insert(fk, target);
+                if (!relatedKeys.contains(fk)) {
+                    relatedKeys.insert(fk);
+                    related << target;
+                }
+                continue;
+            }
+            fks << toOneRelation->foreignKey();
+        }
+        else {
+            QpRelationToManyBase *toManyRelation = static_cast<QpRelationToManyBase *>(r);
+            if (toManyRelation->isResolved()) {
+                foreach (QSharedPointer<QObject> target, toManyRelation->objects()) {
+                    int fk = Qp::Private::primaryKey(target.data());
+                    objectsByKey.insert(fk, target);
+                    if (!relatedKeys.contains(fk)) {
+                        relatedKeys.insert(fk);
+                        related << target;
+                    }
+                }
+                continue;
+            }
+            fks = toManyRelation->foreignKeys();
+        }
+
+        unresolved << r;
+        foreach (int fk, fks) {
+            if (!relatedKeys.contains(fk)) {
+                relatedKeys.insert(fk);
+                keys << fk;
+            }
+        }
+    }
+
+    if (unresolved.isEmpty())
+        return related;
+
+    if (!keys.isEmpty()) {
+        QpDataAccessObjectBase *dao = dataAccessObject(relation.reverseMetaObject().metaObject());
+        foreach (QSharedPointer<QObject> object, dao->readAllObjects(keys)) {
+            objectsByKey.insert(Qp::Private::primaryKey(object.data()), object);
+            related << object;
+        }
+    }
+
+    foreach (QpRelationBase *r, unresolved) {
+        if (toOne) {
+            QpRelationToOneBase *toOneRelation = static_cast<QpRelationToOneBase *>(r);
+            QSharedPointer<QObject> object = objectsByKey.value(toOneRelation->foreignKey());
+            if (object)
+                toOneRelation->setResolvedObject(object);
+        }
+        else {
+            QpRelationToManyBase *toManyRelation = static_cast<QpRelationToManyBase *>(r);
+            QList<QSharedPointer<QObject> > targets;
+            foreach (int fk, toManyRelation->foreignKeys()) {
+                QSharedPointer<QObject> object = objectsByKey.value(fk);
+                if (object)
+                    targets << object;
+            }
+            toManyRelation->setObjects(targets);
+        }
+    }
+
+    return related;
+}
+
+/*!
+ * Resolves the relations along \a relationPath for all \a objects with one
+ * read per path segment. Paths like "parentObject.owner" are resolved segment
+ * by segment. Returns the related objects of the last segment.
+ */
+QList<QSharedPointer<QObject> > QpStorage::prefetch(const QList<QSharedPointer<QObject> > &objects, const QString &relationPath)
+{
+    QList<QSharedPointer<QObject> > result = objects;
+    foreach (const QString &relationName, relationPath.split('.', QString::SkipEmptyParts)) {
+        result = resolveRelation(result, relationName);
+    }
+    return result;
+}
+
+/*!
+ * Increments the numeric column \a fieldName of \a object according to the
+ * incrementMode() and writes the new value back into the object.
+ *
+ * SequenceIncrement takes the values from blocks, which each data access object
+ * reserves in advance. The values are unique, but they are not monotonic across
+ * data access objects or clients, which use the same sequence: A later increment
+ * may get a smaller value from an older block.
+ *
+ * SequenceIncrement updates the object, which would only be queued inside bulk
+ * database queries (and thus inside a QpSession). So it is rejected with an error
+ * there, instead of reporting an increment, which has not been written.
+ */
 bool QpStorage::incrementNumericColumn(QSharedPointer<QObject> object, const QString &fieldName)
 {
     QpDataAccessObjectBase *dao = dataAccessObject(object);
+    if (data->incrementMode == SequenceIncrement) {
+        if (isBulkDatabaseQueriesStarted()) {
+            setLastError(QpError(QString::fromLatin1("The column %1 can not be incremented with a sequence inside bulk database queries")
+                                 .arg(fieldName),
+                                 QpError::TransactionError));
+            return false;
+        }
+
+        bool ok = false;
+        int value = dao->nextValue(fieldName, &ok);
+        if (!ok)
+            return false;
+
+        object->setProperty(fieldName.toLatin1(), value);
+        return dao->updateObject(object) == Qp::UpdateSuccess;
+    }
+
     if (!dao->incrementNumericColumn(object, fieldName))
         return false;
 
     return dao->synchronizeObject(object, QpDataAccessObjectBase::IgnoreRevision) == Qp::Updated;
 }
 
+int QpStorage::nextValue(const QMetaObject &metaObject, const QString &fieldName, bool *ok)
+{
+    return dataAccessObject(metaObject)->nextValue(fieldName, ok);
+}
+
 Qp::UpdateResult QpStorage::update(QSharedPointer<QObject> object)
 {
     return dataAccessObject(object)->updateObject(object);
@@ -6,8 +6,10 @@
 BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 #include <QObject>
 #include <QDebug>
+#include <QStringList>
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 
+#include "cache.h"
 #include "qpersistence.h"
 #include "private.h"
 #include "sqldataaccessobjecthelper.h"
@@ -17,6 +19,7 @@ END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 class QSqlDatabase;
 class QpAbstractErrorHandler;
 class QpDatasource;
+class QpDatasourceResult;
 class QpError;
 class QpPropertyDependenciesHelper;
 class QpTransactionsHelper;
@@ -34,6 +37,7 @@ public:
     void setSqlDebugEnabled(bool enable);
     bool adjustDatabaseSchema();
     bool createCleanSchema();
+    void databaseSchemaChanged();
 
     QpError lastError() const;
     void setLastError(const QpError &error);
@@ -46,12 +50,38 @@ public:
     bool rollbackTransaction();
 
     void startBulkDatabaseQueries();
-    void commitBulkDatabaseQueries();
+    bool commitBulkDatabaseQueries();
+    void rollbackBulkDatabaseQueries();
+    bool isBulkDatabaseQueriesStarted() const;
 
     void resetAllLastKnownSynchronizations();
 
+    void enableOptimisticConcurrency();
+    bool isOptimisticConcurrencyEnabled() const;
+
+    void enableMaterializedRevisions();
+    bool isMaterializedRevisionsEnabled() const;
+
+    // TableMaximumIncrement sets a column to its maximum + 1 in the database, while
+    // SequenceIncrement assigns the next value of the column's sequence and updates the object.
+    // Sequence values are unique, but not monotonic across clients (see incrementNumericColumn()).
+    enum IncrementMode { TableMaximumIncrement, SequenceIncrement };
+    IncrementMode incrementMode() const;
+    void setIncrementMode(IncrementMode mode);
+    // The number of sequence values, which are reserved with one database query.
+    // Values of a block, which have not been used, are lost, when the storage is destroyed.
+    int sequenceBlockSize() const;
+    void setSequenceBlockSize(int size);
+
+    QpCacheMemoryPool cacheMemoryPool() const;
+    QpCacheStatistics cacheStatistics() const;
+    void resetCacheStatistics();
+
     QpDatasource *datasource() const;
     QpDatasource *asynchronousDatasource() const;
+    QpDatasource *asynchronousDatasource(QpDatasourceResult *result, const QObject *orderedBy = nullptr) const;
+    int asynchronousDatasourceCount() const;
+    void setAsynchronousDatasourceCount(int count);
     void setDatasource(QpDatasource *datasource);
 
     QList<QpDataAccessObjectBase *> dataAccessObjects();
@@ -61,12 +91,15 @@ public:
     Qp::SynchronizeResult synchronize(QSharedPointer<QObject> object, QpDataAccessObjectBase::SynchronizeMode mode);
     Qp::UpdateResult update(QSharedPointer<QObject> object);
     bool incrementNumericColumn(QSharedPointer<QObject> object, const QString &fieldName);
+    int nextValue(const QMetaObject &metaObject, const QString &fieldName, bool *ok = nullptr);
     bool remove(QSharedPointer<QObject> object);
     int primaryKey(QSharedPointer<QObject> object);
     bool isDeleted(QSharedPointer<QObject> object);
     bool markAsDeleted(QSharedPointer<QObject> object);
     bool undelete(QSharedPointer<QObject> object);
     QpDataAccessObjectBase *dataAccessObject(QSharedPointer<QObject> object) const;
+    QList<QSharedPointer<QObject> > resolveRelation(const QList<QSharedPointer<QObject> > &objects, const QString &relationName);
+    QList<QSharedPointer<QObject> > prefetch(const QList<QSharedPointer<QObject> > &objects, const QString &relationPath);
 
     QpPropertyDependenciesHelper *propertyDependenciesHelper() const;
 
@@ -81,8 +114,13 @@ public:
     template<class T> int primaryKey(QSharedPointer<T> object);
     template<class T> QSharedPointer<T> read(int id);
     template<class T> QList<QSharedPointer<T> > readAll(const QpCondition &condition = QpCondition());
+    template<class T> QList<QSharedPointer<T> > readAll(const QpCondition &condition, const QStringList &prefetchRelations);
+    template<class T> QList<QSharedPointer<QObject> > resolveRelation(const QList<QSharedPointer<T> > &objects, const QString &relationName);
+    template<class T> QList<QSharedPointer<QObject> > prefetch(const QList<QSharedPointer<T> > &objects, const QString &relationPath);
+    template<class T> QpCursor<T> openCursor(const QpCondition &condition = QpCondition(), int batchSize = 1000);
     template<class T> int count(const QpCondition &condition = QpCondition());
     template<class T> QSharedPointer<T> create();
+    template<class T> QList<QSharedPointer<T> > createObjects(int count);
     template<class T> Qp::UpdateResult update(QSharedPointer<T> object);
     template<class T> bool remove(QSharedPointer<T> object);
     template<class T> bool markAsDeleted(QSharedPointer<T> object);
@@ -90,6 +128,7 @@ public:
     template<class T> bool isDeleted(QSharedPointer<T> object);
     template<class T> Qp::SynchronizeResult synchronize(QSharedPointer<T> object);
     template<class T> bool incrementNumericColumn(QSharedPointer<T> object, const QString &fieldName);
+    template<class T> int nextValue(const QString &fieldName, bool *ok = nullptr);
     template <class K, class V> void registerMappableTypes();
 #ifndef QP_NO_TIMESTAMPS
     QDateTime databaseTime();
@@ -119,6 +158,10 @@ public:
 
 private:
     void registerDataAccessObject(QpDataAccessObjectBase *dao, const QMetaObject *metaObject);
+    QList<QpDataAccessObjectBase *> bulkDataAccessObjects() const;
+    void rollbackBulkDatabaseQueries(const QList<QpDataAccessObjectBase *> &daos);
+    void startAsynchronousDatasources() const;
+    void stopAsynchronousDatasources();
     QExplicitlySharedDataPointer<QpStorageData> data;
 };
 
@@ -134,6 +177,12 @@ bool QpStorage::incrementNumericColumn(QSharedPointer<T> object, const QString &
     return incrementNumericColumn(qSharedPointerCast<QObject>(object), fieldName);
 }
 
+template <class T>
+int QpStorage::nextValue(const QString &fieldName, bool *ok)
+{
+    return nextValue(T::staticMetaObject, fieldName, ok);
+}
+
 template <class T>
 Qp::SynchronizeResult QpStorage::synchronize(QSharedPointer<T> object)
 {
@@ -219,6 +268,34 @@ QList<QSharedPointer<T> > QpStorage::readAll(const QpCondition &condition)
     return dataAccessObject<T>()->readAllObjects(-1, -1, QpCondition::notDeletedAnd(condition));
 }
 
+template<class T>
+QList<QSharedPointer<T> > QpStorage::readAll(const QpCondition &condition, const QStringList &prefetchRelations)
+{
+    QList<QSharedPointer<T> > result = readAll<T>(condition);
+    foreach (const QString &relationPath, prefetchRelations) {
+        prefetch(result, relationPath);
+    }
+    return result;
+}
+
+template<class T>
+QList<QSharedPointer<QObject> > QpStorage::resolveRelation(const QList<QSharedPointer<T> > &objects, const QString &relationName)
+{
+    return resolveRelation(Qp::castList<QObject>(objects), relationName);
+}
+
+template<class T>
+QList<QSharedPointer<QObject> > QpStorage::prefetch(const QList<QSharedPointer<T> > &objects, const QString &relationPath)
+{
+    return prefetch(Qp::castList<QObject>(objects), relationPath);
+}
+
+template<class T>
+QpCursor<T> QpStorage::openCursor(const QpCondition &condition, int batchSize)
+{
+    return dataAccessObject<T>()->openCursor(QpCondition::notDeletedAnd(condition), {}, batchSize);
+}
+
 template<class T>
 int QpStorage::count(const QpCondition &condition)
 {
@@ -231,6 +308,12 @@ QSharedPointer<T> QpStorage::create()
     return qSharedPointerCast<T>(dataAccessObject<T>()->createObject());
 }
 
+template<class T>
+QList<QSharedPointer<T> > QpStorage::createObjects(int count)
+{
+    return Qp::castList<T>(dataAccessObject<T>()->createObjects(count));
+}
+
 template<class T>
 QpDataAccessObject<T> *QpStorage::dataAccessObject()
 {
@@ -12,6 +12,16 @@ END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 #include "tst_flagstest.h"
 #include "tst_usermanagementtest.h"
 #include "tst_propertydependenciestest.h"
+#include "tst_writetest.h"
+#include "tst_cursortest.h"
+#include "tst_objectlistmodeltest.h"
+#include "tst_sortfilterproxyobjectmodeltest.h"
+#include "tst_bulkdatabasequeriestest.h"
+#include "tst_sessiontest.h"
+#include "tst_sequencetest.h"
+#include "tst_asynchronousdatasourcestest.h"
+#include "tst_optimisticconcurrencytest.h"
+#include "tst_materializedrevisionstest.h"
 
 #include "parentobject.h"
 #include "childobject.h"
@@ -69,6 +79,16 @@ int main(int argc, char *argv[])
     RUNTEST(OneToOneRelationTest);
     RUNTEST(OneToManyRelationTest);
     RUNTEST(ManyToManyRelationsTest);
+    RUNTEST(WriteTest);
+    RUNTEST(CursorTest);
+    RUNTEST(ObjectListModelTest);
+    RUNTEST(SortFilterProxyObjectModelTest);
+    RUNTEST(BulkDatabaseQueriesTest);
+    RUNTEST(SessionTest);
+    RUNTEST(SequenceTest);
+    RUNTEST(AsynchronousDatasourcesTest);
+    RUNTEST(OptimisticConcurrencyTest);
+    RUNTEST(MaterializedRevisionsTest);
 
 #ifndef QP_NO_LOCKS
     RUNTEST(LockTest);
@@ -33,7 +33,17 @@ SOURCES +=  \
     tst_flagstest.cpp \
     tst_usermanagementtest.cpp \
     tests_common.cpp \
-    tst_propertydependenciestest.cpp
+    tst_propertydependenciestest.cpp \
+    tst_writetest.cpp \
+    tst_optimisticconcurrencytest.cpp \
+    tst_materializedrevisionstest.cpp \
+    tst_cursortest.cpp \
+    tst_objectlistmodeltest.cpp \
+    tst_sortfilterproxyobjectmodeltest.cpp \
+    tst_bulkdatabasequeriestest.cpp \
+    tst_sessiontest.cpp \
+    tst_sequencetest.cpp \
+    tst_asynchronousdatasourcestest.cpp
 
 HEADERS += \
     tst_cachetest.h \
@@ -46,4 +56,14 @@ HEADERS += \
     tst_flagstest.h \
     tst_usermanagementtest.h \
     tests_common.h \
-    tst_propertydependenciestest.h
+    tst_propertydependenciestest.h \
+    tst_writetest.h \
+    tst_optimisticconcurrencytest.h \
+    tst_materializedrevisionstest.h \
+    tst_cursortest.h \
+    tst_objectlistmodeltest.h \
+    tst_sortfilterproxyobjectmodeltest.h \
+    tst_bulkdatabasequeriestest.h \
+    tst_sessiontest.h \
+    tst_sequencetest.h \
+    tst_asynchronousdatasourcestest.h
@@ -19,3 +19,42 @@ bool waitForSignal(QObject *sender, const char *signal)
     loop.exec();
     return true;
 }
+
+int counterInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent)
+{
+    QpSqlQuery query(Qp::database());
+    query.prepare(QString("SELECT counter FROM parentobject WHERE _qp_id = %1")
+                  .arg(Qp::primaryKey(parent)));
+    if (!query.exec() || !query.first())
+        return -1;
+    return query.value(0).toInt();
+}
+
+static QStringList *loggedStatements = nullptr;
+
+static void logStatement(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    if (type == QtDebugMsg && loggedStatements)
+        loggedStatements->append(message);
+}
+
+QStringList executedStatements(std::function<void()> function)
+{
+    QStringList statements;
+    loggedStatements = &statements;
+    bool debugEnabled = QpSqlQuery::isDebugEnabled();
+    QpSqlQuery::setDebugEnabled(true);
+    QtMessageHandler previousHandler = qInstallMessageHandler(logStatement);
+
+    function();
+
+    qInstallMessageHandler(previousHandler);
+    QpSqlQuery::setDebugEnabled(debugEnabled);
+    loggedStatements = nullptr;
+
+    QStringList simplified;
+    foreach (const QString &statement, statements) {
+        simplified.append(statement.simplified());
+    }
+    return simplified;
+}
@@ -8,6 +8,8 @@ BEGIN_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 #include <QSqlError>
 END_CLANG_DIAGNOSTIC_IGNORE_WARNINGS
 
+#include <functional>
+
 #include "childobject.h"
 #include "parentobject.h"
 #include "../src/sqlbackend.h"
@@ -18,4 +20,9 @@ QVariant NULLKEY();
 
 bool waitForSignal(QObject *sender, const char *signal);
 
+int counterInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent);
+
+// The simplified statements, which function executes, as logged by QpSqlQuery's debug output
+QStringList executedStatements(std::function<void()> function);
+
 #endif // TESTS_COMMON_H
@@ -0,0 +1,67 @@
+#include "tst_asynchronousdatasourcestest.h"
+
+AsynchronousDatasourcesTest::AsynchronousDatasourcesTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void AsynchronousDatasourcesTest::testAsynchronousDatasources()
+{
+    QpStorage *storage = Qp::defaultStorage();
+    storage->setAsynchronousDatasourceCount(3);
+    QpDataAccessObjectBase *dao = storage->dataAccessObject<TestNameSpace::ParentObject>();
+
+    Qp::createObjects<TestNameSpace::ParentObject>(12);
+    QList<QpDatasource::OrderField> orders = {{QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY, QpDatasource::Ascending}};
+    QList<QSharedPointer<QObject> > expected = dao->readAllObjects(0, 12, QpCondition(), orders);
+
+    // The pages are read by different threads and each reply gets its own page
+    QList<QpReply *> replies;
+    for (int i = 0; i < 4; ++i) {
+        replies << dao->readAllObjectsAsync(i * 3, 3, QpCondition(), orders);
+    }
+
+    for (int i = 0; i < replies.size(); ++i) {
+        QpReply *reply = replies.at(i);
+        if (!reply->isFinished())
+            waitForSignal(reply, SIGNAL(finished()));
+
+        QList<QSharedPointer<QObject> > objects = reply->objects();
+        QCOMPARE(objects.size(), 3);
+        for (int j = 0; j < objects.size(); ++j) {
+            QCOMPARE(objects.at(j), expected.at(i * 3 + j));
+        }
+        reply->deleteLater();
+    }
+
+    storage->setAsynchronousDatasourceCount(1);
+}
+
+void AsynchronousDatasourcesTest::testRestart()
+{
+    QpStorage *storage = Qp::defaultStorage();
+    QpDataAccessObjectBase *dao = storage->dataAccessObject<TestNameSpace::ParentObject>();
+    QString connectionName = storage->database().connectionName().append("DatasourceThread1");
+
+    Qp::createObjects<TestNameSpace::ParentObject>(3);
+
+    // The second start clones the connections under the same names as the first one
+    for (int i = 0; i < 2; ++i) {
+        storage->setAsynchronousDatasourceCount(2);
+
+        QList<QpReply *> replies;
+        replies << dao->readAllObjectsAsync(0, 3) << dao->readAllObjectsAsync(0, 3);
+        foreach (QpReply *reply, replies) {
+            if (!reply->isFinished())
+                waitForSignal(reply, SIGNAL(finished()));
+
+            QCOMPARE(reply->objects().size(), 3);
+            reply->deleteLater();
+        }
+        QVERIFY(QSqlDatabase::connectionNames().contains(connectionName));
+
+        // Stopping waits for the threads, which have removed their connections
+        storage->setAsynchronousDatasourceCount(1);
+        QVERIFY(!QSqlDatabase::connectionNames().contains(connectionName));
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef TST_ASYNCHRONOUSDATASOURCESTEST_H
+#define TST_ASYNCHRONOUSDATASOURCESTEST_H
+
+#include "tests_common.h"
+
+class AsynchronousDatasourcesTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AsynchronousDatasourcesTest(QObject *parent = 0);
+
+private slots:
+    void testAsynchronousDatasources();
+    void testRestart();
+};
+
+#endif // TST_ASYNCHRONOUSDATASOURCESTEST_H
@@ -0,0 +1,75 @@
+#include "tst_bulkdatabasequeriestest.h"
+
+#include <QSqlRecord>
+
+BulkDatabaseQueriesTest::BulkDatabaseQueriesTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void BulkDatabaseQueriesTest::testBulkDatabaseQueries()
+{
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(3);
+    QSharedPointer<TestNameSpace::ParentObject> removed = parents.takeLast();
+    int removedKey = Qp::primaryKey(removed);
+
+    Qp::defaultStorage()->startBulkDatabaseQueries();
+    for (int i = 0; i < parents.size(); ++i) {
+        parents.at(i)->setCounter(1);
+        QCOMPARE(Qp::update(parents.at(i)), Qp::UpdateSuccess);
+        parents.at(i)->setCounter(i + 10);
+        QCOMPARE(Qp::update(parents.at(i)), Qp::UpdateSuccess);
+    }
+    QVERIFY(Qp::remove(removed));
+
+    // Nothing has been written yet
+    QCOMPARE(counterInDatabase(parents.first()), 0);
+
+    QVERIFY(Qp::defaultStorage()->commitBulkDatabaseQueries());
+
+    // The last update of each object wins
+    for (int i = 0; i < parents.size(); ++i) {
+        QCOMPARE(counterInDatabase(parents.at(i)), i + 10);
+    }
+    QVERIFY(!Qp::read<TestNameSpace::ParentObject>(removedKey));
+}
+
+void BulkDatabaseQueriesTest::testKeepOrder()
+{
+    // Without the version column the revisions of the objects are checked before the batch is written
+    QVERIFY(!Qp::database().record("parentobject").contains(QpDatabaseSchema::COLUMN_NAME_VERSION));
+
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(3);
+    QStringList statements = executedStatements([&] {
+        Qp::defaultStorage()->startBulkDatabaseQueries();
+        parents.at(0)->setCounter(1);
+        QCOMPARE(Qp::update(parents.at(0)), Qp::UpdateSuccess);
+        parents.at(1)->setAString("second");
+        QCOMPARE(Qp::update(parents.at(1)), Qp::UpdateSuccess);
+        parents.at(2)->setCounter(3);
+        QCOMPARE(Qp::update(parents.at(2)), Qp::UpdateSuccess);
+        QVERIFY(Qp::defaultStorage()->commitBulkDatabaseQueries());
+    });
+
+    // Only consecutive executions of the same statement are batched
+    QStringList updates;
+    int revisionReads = 0;
+    foreach (const QString &statement, statements) {
+        if (statement.startsWith("UPDATE", Qt::CaseInsensitive)
+                && statement.section(' ', 1, 1).contains("parentobject", Qt::CaseInsensitive)) {
+            updates.append(statement.section(" WHERE ", 0, 0, QString::SectionCaseInsensitiveSeps));
+        }
+        else if (statement.startsWith("SELECT", Qt::CaseInsensitive)
+                 && statement.contains("GROUP BY", Qt::CaseInsensitive)) {
+            ++revisionReads;
+        }
+    }
+    QCOMPARE(updates.size(), 3);
+    QVERIFY2(updates.at(0).contains("counter", Qt::CaseInsensitive), qPrintable(updates.at(0)));
+    QVERIFY2(updates.at(1).contains("astring", Qt::CaseInsensitive), qPrintable(updates.at(1)));
+    QVERIFY2(updates.at(2).contains("counter", Qt::CaseInsensitive), qPrintable(updates.at(2)));
+    QCOMPARE(revisionReads, 1);
+
+    QCOMPARE(counterInDatabase(parents.at(0)), 1);
+    QCOMPARE(counterInDatabase(parents.at(2)), 3);
+}
@@ -0,0 +1,17 @@
+#ifndef TST_BULKDATABASEQUERIESTEST_H
+#define TST_BULKDATABASEQUERIESTEST_H
+
+#include "tests_common.h"
+
+class BulkDatabaseQueriesTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BulkDatabaseQueriesTest(QObject *parent = 0);
+
+private slots:
+    void testBulkDatabaseQueries();
+    void testKeepOrder();
+};
+
+#endif // TST_BULKDATABASEQUERIESTEST_H
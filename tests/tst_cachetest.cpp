@@ -2,6 +2,16 @@
 
 #include "../src/cache.h"
 
+class FixedSizeEstimator : public QpCacheSizeEstimator
+{
+public:
+    qint64 estimateSize(const QObject *object) const Q_DECL_OVERRIDE
+    {
+        Q_UNUSED(object);
+        return 100;
+    }
+};
+
 CacheTest::CacheTest()
 {
 }
@@ -112,3 +122,185 @@ void CacheTest::testCacheReOrderingUponAccess()
     QVERIFY(weakRef4.toStrongRef());
     QVERIFY(!weakRef5.toStrongRef());
 }
+
+void CacheTest::testRepeatedAccessDoesNotEvictOthers()
+{
+    QpCache cache;
+    int cacheSize = 10;
+    cache.setMaximumCacheSize(cacheSize);
+
+    QWeakPointer<QObject> weakRef2;
+    QWeakPointer<QObject> weakRef3;
+
+    for (int i = 1; i <= cacheSize; ++i) {
+        QWeakPointer<QObject> weak = cache.insert(i, new QObject()).toWeakRef();
+
+        if (i == 2) {
+            weakRef2 = weak;
+        }
+        if (i == 3) {
+            weakRef3 = weak;
+        }
+    }
+
+    // Hits on the same object must not push other objects out of the cache
+    for (int i = 0; i < 3 * cacheSize; ++i) {
+        cache.get(1);
+    }
+
+    QVERIFY(weakRef2.toStrongRef());
+    QVERIFY(weakRef3.toStrongRef());
+
+    cache.insert(11, new QObject());
+
+    QVERIFY(cache.get(1));
+    QVERIFY(!weakRef2.toStrongRef());
+    QVERIFY(weakRef3.toStrongRef());
+}
+
+void CacheTest::testMaximumCacheCost()
+{
+    QpCache cache;
+    cache.setMaximumCacheSize(-1);
+    cache.setSizeEstimator(QSharedPointer<QpCacheSizeEstimator>(new FixedSizeEstimator));
+    cache.setMaximumCacheCost(1000);
+
+    QWeakPointer<QObject> weakRef1 = cache.insert(1, new QObject()).toWeakRef();
+    QWeakPointer<QObject> weakRef2 = cache.insert(2, new QObject()).toWeakRef();
+
+    for (int i = 3; i <= 10; ++i) {
+        cache.insert(i, new QObject());
+    }
+
+    QCOMPARE(cache.cacheCost(), qint64(1000));
+    QVERIFY(weakRef1.toStrongRef());
+
+    cache.insert(11, new QObject());
+
+    QCOMPARE(cache.cacheCost(), qint64(1000));
+    QVERIFY(!weakRef1.toStrongRef());
+    QVERIFY(weakRef2.toStrongRef());
+
+    cache.setMaximumCacheCost(500);
+    QCOMPARE(cache.cacheCost(), qint64(500));
+    QVERIFY(!weakRef2.toStrongRef());
+}
+
+void CacheTest::testMemoryPool()
+{
+    QpCacheMemoryPool pool;
+    pool.setMaximumCost(500);
+
+    QpCache cache1;
+    cache1.setSizeEstimator(QSharedPointer<QpCacheSizeEstimator>(new FixedSizeEstimator));
+    cache1.setMemoryPool(pool);
+
+    QpCache cache2;
+    cache2.setSizeEstimator(QSharedPointer<QpCacheSizeEstimator>(new FixedSizeEstimator));
+    cache2.setMemoryPool(pool);
+
+    QWeakPointer<QObject> weakRef1 = cache1.insert(1, new QObject()).toWeakRef();
+    QWeakPointer<QObject> weakRef2 = cache1.insert(2, new QObject()).toWeakRef();
+    cache1.insert(3, new QObject());
+    cache2.insert(4, new QObject());
+    cache2.insert(5, new QObject());
+
+    QCOMPARE(pool.cost(), qint64(500));
+
+    // The least recently used object of all caches in the pool gets evicted
+    cache2.insert(6, new QObject());
+
+    QCOMPARE(pool.cost(), qint64(500));
+    QCOMPARE(cache1.cacheCost(), qint64(200));
+    QCOMPARE(cache2.cacheCost(), qint64(300));
+    QVERIFY(!weakRef1.toStrongRef());
+    QVERIFY(weakRef2.toStrongRef());
+}
+
+void CacheTest::testMemoryPoolRepeatedAccess()
+{
+    QpCacheMemoryPool pool;
+    pool.setMaximumCost(300);
+
+    QpCache cache1;
+    cache1.setSizeEstimator(QSharedPointer<QpCacheSizeEstimator>(new FixedSizeEstimator));
+    cache1.setMemoryPool(pool);
+
+    QpCache cache2;
+    cache2.setSizeEstimator(QSharedPointer<QpCacheSizeEstimator>(new FixedSizeEstimator));
+    cache2.setMemoryPool(pool);
+
+    QWeakPointer<QObject> weakRef1 = cache1.insert(1, new QObject()).toWeakRef();
+    QWeakPointer<QObject> weakRef2 = cache2.insert(2, new QObject()).toWeakRef();
+    cache2.insert(3, new QObject());
+
+    // 1 is the most recently used object of cache1 already, but the hit has to make it the newest of the pool
+    cache1.get(1);
+    cache2.insert(4, new QObject());
+
+    QVERIFY(weakRef1.toStrongRef());
+    QVERIFY(!weakRef2.toStrongRef());
+}
+
+void CacheTest::testStatistics()
+{
+    QpCache cache;
+    cache.setMaximumCacheSize(2);
+
+    QSharedPointer<QObject> strongRef1 = cache.insert(1, new QObject());
+    cache.insert(2, new QObject());
+    cache.insert(3, new QObject());
+
+    cache.get(3);
+    cache.get(1);
+    cache.get(42);
+    cache.remove(2);
+
+    QpCacheStatistics statistics = cache.statistics();
+    QCOMPARE(statistics.inserts, quint64(3));
+    QCOMPARE(statistics.evictions, quint64(2));
+    QCOMPARE(statistics.hits, quint64(1));
+    QCOMPARE(statistics.resurrections, quint64(1));
+    QCOMPARE(statistics.misses, quint64(1));
+    QCOMPARE(statistics.removes, quint64(1));
+
+    cache.resetStatistics();
+    statistics = cache.statistics();
+    QCOMPARE(statistics.inserts, quint64(0));
+    QCOMPARE(statistics.hits, quint64(0));
+}
+
+void CacheTest::testProbationAdmissionPolicy()
+{
+    QpCache cache;
+    int cacheSize = 10;
+    cache.setMaximumCacheSize(cacheSize);
+    cache.setAdmissionPolicy(QpCache::Probation);
+
+    QList<QWeakPointer<QObject> > hotObjects;
+    for (int i = 1; i <= 5; ++i) {
+        hotObjects << cache.insert(i, new QObject()).toWeakRef();
+        cache.get(i);
+    }
+
+    // A bulk read of many objects must not evict the objects, which have been accessed repeatedly
+    for (int i = 100; i < 100 + 10 * cacheSize; ++i) {
+        cache.insert(i, new QObject());
+    }
+
+    foreach (QWeakPointer<QObject> weak, hotObjects) {
+        QVERIFY(weak.toStrongRef());
+    }
+
+    // Without the probation segment the scan flushes the cache
+    QpCache lruCache;
+    lruCache.setMaximumCacheSize(cacheSize);
+    QWeakPointer<QObject> weakRef = lruCache.insert(1, new QObject()).toWeakRef();
+    lruCache.get(1);
+
+    for (int i = 100; i < 100 + 10 * cacheSize; ++i) {
+        lruCache.insert(i, new QObject());
+    }
+
+    QVERIFY(!weakRef.toStrongRef());
+}
@@ -15,6 +15,12 @@ private slots:
     void testRemove();
     void testMaximumCacheSize();
     void testCacheReOrderingUponAccess();
+    void testRepeatedAccessDoesNotEvictOthers();
+    void testMaximumCacheCost();
+    void testMemoryPool();
+    void testMemoryPoolRepeatedAccess();
+    void testStatistics();
+    void testProbationAdmissionPolicy();
 };
 
 #endif // TST_CACHETEST_H
@@ -0,0 +1,43 @@
+#include "tst_cursortest.h"
+
+#include <algorithm>
+
+CursorTest::CursorTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void CursorTest::testCursor()
+{
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(25);
+    QList<int> keys;
+    foreach (QSharedPointer<TestNameSpace::ParentObject> parent, parents) {
+        keys.append(Qp::primaryKey(parent));
+    }
+
+    QpDatasource::OrderField byKey;
+    byKey.field = QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY;
+    byKey.order = QpDatasource::Ascending;
+
+    QpCursor<TestNameSpace::ParentObject> cursor = Qp::dataAccessObject<TestNameSpace::ParentObject>()->openCursor(QpCondition::primaryKeys(keys),
+                                                                                                                 QList<QpDatasource::OrderField>() << byKey,
+                                                                                                                 10);
+    QVERIFY(cursor.isValid());
+
+    QList<int> batchSizes;
+    QList<int> readKeys;
+    while (!cursor.atEnd()) {
+        QList<QSharedPointer<TestNameSpace::ParentObject> > batch = cursor.next();
+        batchSizes << batch.size();
+        foreach (QSharedPointer<TestNameSpace::ParentObject> parent, batch) {
+            QVERIFY(parents.contains(parent));
+            readKeys << Qp::primaryKey(parent);
+        }
+    }
+
+    QVERIFY(cursor.isValid());
+    QCOMPARE(batchSizes, QList<int>() << 10 << 10 << 5);
+    std::sort(keys.begin(), keys.end());
+    QCOMPARE(readKeys, keys);
+    QVERIFY(cursor.next().isEmpty());
+}
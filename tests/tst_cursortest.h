@@ -0,0 +1,16 @@
+#ifndef TST_CURSORTEST_H
+#define TST_CURSORTEST_H
+
+#include "tests_common.h"
+
+class CursorTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CursorTest(QObject *parent = 0);
+
+private slots:
+    void testCursor();
+};
+
+#endif // TST_CURSORTEST_H
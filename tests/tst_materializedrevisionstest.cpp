@@ -0,0 +1,134 @@
+#include "tst_materializedrevisionstest.h"
+
+#include <QPersistence/legacysqldatasource.h>
+
+MaterializedRevisionsTest::MaterializedRevisionsTest(QObject *parent) :
+    QObject(parent),
+    m_storage(nullptr)
+{
+}
+
+void MaterializedRevisionsTest::initTestCase()
+{
+#ifndef QP_FOR_MYSQL
+    QSKIP("The history triggers are only available for MySQL");
+#else
+    // The other tests use the default storage without materialized revisions,
+    // so that this test gets its own storage and its own connection
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(Qp::database(), "MaterializedRevisionsTest");
+    QVERIFY(db.open());
+
+    m_storage = new QpStorage(this);
+    QpLegacySqlDatasource *ds = new QpLegacySqlDatasource(m_storage);
+    ds->setSqlDatabase(db);
+    m_storage->setDatasource(ds);
+    m_storage->setDatabase(db);
+    m_storage->enableMaterializedRevisions();
+    m_storage->registerClass<TestNameSpace::ParentObject>();
+    m_storage->registerClass<TestNameSpace::ChildObject>();
+
+    // Adds the revision columns to the shared tables and copies the latest revisions from the history
+    QVERIFY(m_storage->adjustDatabaseSchema());
+#endif
+}
+
+void MaterializedRevisionsTest::cleanupTestCase()
+{
+#ifdef QP_FOR_MYSQL
+    // MySQL shares the tables with the other tests, which expect the plain history triggers
+    QpSqlQuery query(m_storage->database());
+    foreach (QString table, QStringList() << "parentobject" << "childobject") {
+        QVERIFY(query.exec(QString("DROP TRIGGER IF EXISTS `%1_Qp_history_INSERT`").arg(table)));
+        QVERIFY(query.exec(QString("DROP TRIGGER IF EXISTS `%1_Qp_history_INSERT_ID`").arg(table)));
+        QVERIFY(query.exec(QString("DROP TRIGGER IF EXISTS `%1_Qp_history_UPDATE`").arg(table)));
+        QVERIFY(query.exec(QString("ALTER TABLE `%1` DROP COLUMN _Qp_revision, DROP COLUMN _Qp_action").arg(table)));
+        QVERIFY(query.exec(QString("CREATE TRIGGER `%1_Qp_history_INSERT` AFTER INSERT ON `%1` FOR EACH ROW "
+                                   "INSERT INTO `%1_Qp_history` VALUES ("
+                                   "NULL, "
+                                   "NEW.`_Qp_ID`,"
+                                   "'INSERT', "
+                                   "NOW(6) + 0,"
+                                   "CURRENT_USER()"
+                                   ");").arg(table)));
+        QVERIFY(query.exec(QString("CREATE TRIGGER `%1_Qp_history_UPDATE` AFTER UPDATE ON `%1` FOR EACH ROW "
+                                   "INSERT INTO `%1_Qp_history` VALUES ("
+                                   "NULL, "
+                                   "NEW.`_Qp_ID`,"
+                                   "CASE WHEN NEW.`_Qp_deleted` = 0 THEN 'UPDATE' ELSE 'MARK_AS_DELETE' END, "
+                                   "NOW(6) + 0,"
+                                   "CURRENT_USER()"
+                                   ");").arg(table)));
+    }
+    Qp::defaultStorage()->databaseSchemaChanged();
+#endif
+
+    delete m_storage;
+    m_storage = nullptr;
+}
+
+QVariantList MaterializedRevisionsTest::revisionColumns(QSharedPointer<TestNameSpace::ParentObject> parent)
+{
+    QpSqlQuery query(m_storage->database());
+    query.prepare(QString("SELECT _Qp_revision, _Qp_action FROM parentobject WHERE _Qp_ID = %1")
+                  .arg(m_storage->primaryKey(parent)));
+    if (!query.exec() || !query.first())
+        return QVariantList();
+    return QVariantList() << query.value(0).toInt() << query.value(1).toString();
+}
+
+QList<QVariantList> MaterializedRevisionsTest::historyRows(QSharedPointer<TestNameSpace::ParentObject> parent)
+{
+    QList<QVariantList> rows;
+    QpSqlQuery query(m_storage->database());
+    query.prepare(QString("SELECT _Qp_revision, _Qp_action FROM parentobject_Qp_history "
+                          "WHERE _Qp_ID = %1 ORDER BY _Qp_revision")
+                  .arg(m_storage->primaryKey(parent)));
+    if (!query.exec())
+        return rows;
+    while (query.next())
+        rows.append(QVariantList() << query.value(0).toInt() << query.value(1).toString());
+    return rows;
+}
+
+void MaterializedRevisionsTest::testRevisionAfterInsert()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = m_storage->create<TestNameSpace::ParentObject>();
+    QpDataAccessObjectBase *dao = m_storage->dataAccessObject(parent);
+
+    // The row carries the revision of its history entry right after the INSERT
+    QList<QVariantList> history = historyRows(parent);
+    QCOMPARE(history.size(), 1);
+    QCOMPARE(history.first().at(1).toString(), QString("INSERT"));
+    QVERIFY(history.first().first().toInt() > 0);
+    QCOMPARE(revisionColumns(parent), history.first());
+    QCOMPARE(dao->revisionInDatabase(parent), history.first().first().toInt());
+    QCOMPARE(Qp::Private::revisionInObject(parent.data()), history.first().first().toInt());
+
+    // Objects, which are inserted with one statement, get a revision each
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = m_storage->createObjects<TestNameSpace::ParentObject>(3);
+    QCOMPARE(parents.size(), 3);
+    foreach (QSharedPointer<TestNameSpace::ParentObject> created, parents) {
+        history = historyRows(created);
+        QCOMPARE(history.size(), 1);
+        QCOMPARE(revisionColumns(created), history.first());
+        QCOMPARE(Qp::Private::revisionInObject(created.data()), history.first().first().toInt());
+    }
+}
+
+void MaterializedRevisionsTest::testRevisionAfterUpdate()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = m_storage->create<TestNameSpace::ParentObject>();
+    QpDataAccessObjectBase *dao = m_storage->dataAccessObject(parent);
+
+    for (int i = 1; i <= 2; ++i) {
+        parent->setCounter(i);
+        QCOMPARE(m_storage->update(parent), Qp::UpdateSuccess);
+
+        // The row carries the revision of its latest history entry
+        QList<QVariantList> history = historyRows(parent);
+        QCOMPARE(history.size(), i + 1);
+        QCOMPARE(history.last().at(1).toString(), QString("UPDATE"));
+        QCOMPARE(revisionColumns(parent), history.last());
+        QCOMPARE(dao->revisionInDatabase(parent), history.last().first().toInt());
+    }
+}
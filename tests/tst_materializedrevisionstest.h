@@ -0,0 +1,26 @@
+#ifndef TST_MATERIALIZEDREVISIONSTEST_H
+#define TST_MATERIALIZEDREVISIONSTEST_H
+
+#include "tests_common.h"
+
+class MaterializedRevisionsTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MaterializedRevisionsTest(QObject *parent = 0);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRevisionAfterInsert();
+    void testRevisionAfterUpdate();
+
+private:
+    QpStorage *m_storage;
+
+    QVariantList revisionColumns(QSharedPointer<TestNameSpace::ParentObject> parent);
+    QList<QVariantList> historyRows(QSharedPointer<TestNameSpace::ParentObject> parent);
+};
+
+#endif // TST_MATERIALIZEDREVISIONSTEST_H
@@ -0,0 +1,155 @@
+#include "tst_objectlistmodeltest.h"
+
+#include <algorithm>
+
+ObjectListModelTest::ObjectListModelTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void ObjectListModelTest::testReadAllObjectsAfter()
+{
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(12);
+    QList<int> keys;
+    foreach (QSharedPointer<TestNameSpace::ParentObject> parent, parents) {
+        keys.append(Qp::primaryKey(parent));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    QpDataAccessObjectBase *dao = Qp::dataAccessObject<TestNameSpace::ParentObject>();
+    QpCondition condition = QpCondition::primaryKeys(keys);
+
+    QList<int> readKeys;
+    QVariant lastKey;
+    forever {
+        QList<QSharedPointer<QObject> > page = dao->readAllObjectsAfter(lastKey, 5, condition);
+        if (page.isEmpty())
+            break;
+
+        QVERIFY(page.size() <= 5);
+        foreach (QSharedPointer<QObject> object, page) {
+            readKeys << Qp::Private::primaryKey(object.data());
+        }
+        lastKey = readKeys.last();
+    }
+
+    // The pages are read in key order without gaps or duplicates
+    QCOMPARE(readKeys, keys);
+
+    QpDatasource::OrderField descending;
+    descending.field = QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY;
+    descending.order = QpDatasource::Descending;
+    QList<QSharedPointer<QObject> > page = dao->readAllObjectsAfter(keys.last(), 3, condition, descending);
+    QCOMPARE(page.size(), 3);
+    QCOMPARE(Qp::Private::primaryKey(page.first().data()), keys.at(keys.size() - 2));
+}
+
+void ObjectListModelTest::testCount()
+{
+    QpObjectListModel<TestNameSpace::ParentObject> model;
+    model.setFetchCount(5);
+    QCOMPARE(model.totalCount(), Qp::count<TestNameSpace::ParentObject>());
+
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QCOMPARE(model.totalCount(), Qp::count<TestNameSpace::ParentObject>());
+    QVERIFY(model.indexForObjectBase(parent).isValid());
+
+    while (model.canFetchMore())
+        model.fetchMore();
+    QCOMPARE(model.rowCount(), model.totalCount());
+
+    model.setCountMode(QpObjectListModelBase::ApproximateCount);
+    QVERIFY(model.totalCount() >= model.rowCount());
+    QVERIFY(model.canFetchMore());
+    model.fetchMore();
+    QVERIFY(!model.canFetchMore());
+    QCOMPARE(model.rowCount(), Qp::count<TestNameSpace::ParentObject>());
+}
+
+void ObjectListModelTest::testRows()
+{
+    Qp::createObjects<TestNameSpace::ParentObject>(10);
+
+    QpObjectListModel<TestNameSpace::ParentObject> model;
+    model.setFetchCount(4);
+    while (model.canFetchMore())
+        model.fetchMore();
+
+    QList<QSharedPointer<TestNameSpace::ParentObject> > objects = model.objects();
+    int rowCount = model.rowCount();
+    QVERIFY(rowCount >= 10);
+
+    int row = rowCount - 5;
+    QSharedPointer<TestNameSpace::ParentObject> object = objects.at(row);
+    QCOMPARE(model.indexForObjectBase(object).row(), row);
+
+    QVERIFY(Qp::markAsDeleted(object));
+    QCOMPARE(model.rowCount(), rowCount - 1);
+    QVERIFY(!model.indexForObjectBase(object).isValid());
+    QCOMPARE(model.indexForObjectBase(objects.at(row + 1)).row(), row);
+
+    // The undeleted object returns to its row without asking the database
+    QVERIFY(Qp::undelete(object));
+    QCOMPARE(model.rowCount(), rowCount);
+    QCOMPARE(model.indexForObjectBase(object).row(), row);
+    QCOMPARE(model.indexForObjectBase(objects.at(row + 1)).row(), row + 1);
+}
+
+void ObjectListModelTest::testAsynchronousFetch()
+{
+    Qp::createObjects<TestNameSpace::ParentObject>(10);
+
+    QpObjectListModel<TestNameSpace::ParentObject> model;
+    model.setAsynchronous(true);
+    model.setFetchCount(4);
+    QVERIFY(model.canFetchMore());
+
+    model.fetchMore();
+    QVERIFY(model.isLoading());
+    QVERIFY(!model.canFetchMore()); // one page at a time
+    QCOMPARE(model.rowCount(), 0);
+
+    waitForSignal(&model, SIGNAL(loadingChanged(bool)));
+    QVERIFY(!model.isLoading());
+    QCOMPARE(model.rowCount(), 4);
+
+    // Changing the condition drops the page, which is being read
+    model.fetchMore();
+    QVERIFY(model.isLoading());
+    model.setCondition(QpCondition());
+    QVERIFY(!model.isLoading());
+    QCOMPARE(model.rowCount(), 0);
+
+    while (model.canFetchMore()) {
+        model.fetchMore();
+        waitForSignal(&model, SIGNAL(loadingChanged(bool)));
+    }
+    QCOMPARE(model.rowCount(), Qp::count<TestNameSpace::ParentObject>());
+}
+
+void ObjectListModelTest::testAsynchronousFetchError()
+{
+    QpObjectListModel<TestNameSpace::ParentObject> model;
+    model.setAsynchronous(true);
+    model.setCountMode(QpObjectListModelBase::ApproximateCount);
+    model.setFetchCount(4);
+    model.setCondition(QpCondition(QLatin1String("noSuchColumn = 1")));
+
+    model.fetchMore();
+    QVERIFY(model.isLoading());
+    waitForSignal(&model, SIGNAL(loadingChanged(bool)));
+
+    // The failed page is reported and may be fetched again
+    QVERIFY(!model.isLoading());
+    QVERIFY(model.lastError().isValid());
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(model.canFetchMore());
+    Qp::defaultStorage()->setLastError(QpError());
+
+    model.setCondition(QpCondition());
+    QVERIFY(!model.lastError().isValid());
+    model.fetchMore();
+    waitForSignal(&model, SIGNAL(loadingChanged(bool)));
+    QVERIFY(!model.lastError().isValid());
+    QCOMPARE(model.rowCount(), 4);
+}
@@ -0,0 +1,20 @@
+#ifndef TST_OBJECTLISTMODELTEST_H
+#define TST_OBJECTLISTMODELTEST_H
+
+#include "tests_common.h"
+
+class ObjectListModelTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ObjectListModelTest(QObject *parent = 0);
+
+private slots:
+    void testReadAllObjectsAfter();
+    void testCount();
+    void testRows();
+    void testAsynchronousFetch();
+    void testAsynchronousFetchError();
+};
+
+#endif // TST_OBJECTLISTMODELTEST_H
@@ -1,5 +1,7 @@
 #include "tst_onetomanyrelationtest.h"
 
+#include "../src/datasourceresult.h"
+
 OneToManyRelationTest::OneToManyRelationTest(QObject *parent) :
     QObject(parent)
 {
@@ -345,3 +347,125 @@ void OneToManyRelationTest::testDatabaseFKChangeFromChild()
     }
 }
 
+
+void OneToManyRelationTest::testDatabaseFKOnlyChangedChildren()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QSharedPointer<TestNameSpace::ChildObject> unchangedChild = Qp::create<TestNameSpace::ChildObject>();
+    parent->addChildObjectsOneToMany(unchangedChild);
+    Qp::update(parent);
+    QCOMPARE(parentFK(unchangedChild), QVariant(Qp::primaryKey(parent)));
+
+    // Change the foreign key behind our back
+    QpSqlQuery reset(Qp::database());
+    reset.setTable(m_childToParentRelation.tableName());
+    reset.addField(m_childToParentRelation.columnName(), QVariant());
+    reset.setWhereCondition(QpCondition(QpDatabaseSchema::COLUMN_NAME_PRIMARY_KEY,
+                                        QpCondition::EqualTo,
+                                        Qp::primaryKey(unchangedChild)));
+    reset.prepareUpdate();
+    QVERIFY(reset.exec());
+
+    // Only the added child is written
+    QSharedPointer<TestNameSpace::ChildObject> addedChild = Qp::create<TestNameSpace::ChildObject>();
+    parent->addChildObjectsOneToMany(addedChild);
+    Qp::update(parent);
+    QCOMPARE(parentFK(addedChild), QVariant(Qp::primaryKey(parent)));
+    QCOMPARE(parentFK(unchangedChild), NULLKEY());
+}
+
+void OneToManyRelationTest::testPrefetchToOneRelation()
+{
+    QpMetaProperty relation = QpMetaObject::forClassName(TestNameSpace::ChildObject::staticMetaObject.className()).metaProperty("belongsToOneMany");
+
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(3);
+    QList<QSharedPointer<TestNameSpace::ChildObject> > children = Qp::createObjects<TestNameSpace::ChildObject>(9);
+    QList<int> childKeys;
+    for (int i = 0; i < children.size(); ++i) {
+        parents.at(i % parents.size())->addHasMany(children.at(i));
+        QCOMPARE(Qp::update(children.at(i)), Qp::UpdateSuccess);
+        childKeys << Qp::primaryKey(children.at(i));
+    }
+
+    // Forget the resolved parents, as if the children had just been read
+    foreach (QSharedPointer<TestNameSpace::ChildObject> child, children) {
+        QpRelationToOneBase *r = static_cast<QpRelationToOneBase *>(relation.internalRelationObject(child.data()));
+        r->adjustFromDataTransferObject(QpDataTransferObject::fromObject(child.data()));
+        QVERIFY(!r->isResolved());
+    }
+
+    QList<QSharedPointer<TestNameSpace::ChildObject> > read = Qp::readAll<TestNameSpace::ChildObject>(QpCondition::primaryKeys(childKeys),
+                                                                                                   QStringList() << "belongsToOneMany");
+    QCOMPARE(read.size(), children.size());
+    for (int i = 0; i < children.size(); ++i) {
+        QpRelationToOneBase *r = static_cast<QpRelationToOneBase *>(relation.internalRelationObject(children.at(i).data()));
+        QVERIFY(r->isResolved());
+        QCOMPARE(children.at(i)->belongsToOneMany(), parents.at(i % parents.size()));
+    }
+
+    QList<QSharedPointer<QObject> > related = Qp::prefetch(children, "belongsToOneMany");
+    QCOMPARE(related.size(), parents.size());
+}
+
+void OneToManyRelationTest::testResolveToManyRelation()
+{
+    QpMetaProperty relation = QpMetaObject::forClassName(TestNameSpace::ParentObject::staticMetaObject.className()).metaProperty("hasMany");
+
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(3);
+    QList<QSharedPointer<TestNameSpace::ChildObject> > children = Qp::createObjects<TestNameSpace::ChildObject>(9);
+    for (int i = 0; i < children.size(); ++i) {
+        parents.at(i % parents.size())->addHasMany(children.at(i));
+        QCOMPARE(Qp::update(children.at(i)), Qp::UpdateSuccess);
+    }
+
+    // Forget the resolved children, as if the parents had just been read
+    foreach (QSharedPointer<TestNameSpace::ParentObject> parent, parents) {
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        QpRelationToManyBase *r = static_cast<QpRelationToManyBase *>(relation.internalRelationObject(parent.data()));
+        r->adjustFromDataTransferObject(QpDataTransferObject::fromObject(parent.data()));
+        QVERIFY(!r->isResolved());
+        QCOMPARE(r->foreignKeys().size(), 3);
+    }
+
+    QList<QSharedPointer<QObject> > related = Qp::resolveRelation(parents, "hasMany");
+    QCOMPARE(related.size(), children.size());
+
+    for (int i = 0; i < parents.size(); ++i) {
+        QpRelationToManyBase *r = static_cast<QpRelationToManyBase *>(relation.internalRelationObject(parents.at(i).data()));
+        QVERIFY(r->isResolved());
+        QList<QSharedPointer<TestNameSpace::ChildObject> > hasChildren = parents.at(i)->hasMany();
+        QCOMPARE(hasChildren.size(), 3);
+        foreach (QSharedPointer<TestNameSpace::ChildObject> child, hasChildren) {
+            QCOMPARE(children.indexOf(child) % parents.size(), i);
+        }
+    }
+
+    // Both kinds of relations along one path
+    QCOMPARE(Qp::prefetch(parents, "hasMany.belongsToOneMany").size(), parents.size());
+}
+
+void OneToManyRelationTest::testResolveSharedTarget()
+{
+    QpMetaProperty relation = QpMetaObject::forClassName(TestNameSpace::ChildObject::staticMetaObject.className()).metaProperty("belongsToOneMany");
+
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QList<QSharedPointer<TestNameSpace::ChildObject> > children = Qp::createObjects<TestNameSpace::ChildObject>(2);
+    foreach (QSharedPointer<TestNameSpace::ChildObject> child, children) {
+        parent->addHasMany(child);
+        QCOMPARE(Qp::update(child), Qp::UpdateSuccess);
+    }
+
+    // Only the first child still knows its parent
+    QpRelationToOneBase *resolved = static_cast<QpRelationToOneBase *>(relation.internalRelationObject(children.first().data()));
+    QpRelationToOneBase *unresolved = static_cast<QpRelationToOneBase *>(relation.internalRelationObject(children.last().data()));
+    unresolved->adjustFromDataTransferObject(QpDataTransferObject::fromObject(children.last().data()));
+    QVERIFY(resolved->isResolved());
+    QVERIFY(!unresolved->isResolved());
+
+    QList<QSharedPointer<QObject> > related = Qp::resolveRelation(children, "belongsToOneMany");
+    QCOMPARE(related.size(), 1);
+    QCOMPARE(related.first(), parent.objectCast<QObject>());
+
+    QVERIFY(unresolved->isResolved());
+    QCOMPARE(children.last()->belongsToOneMany(), parent);
+}
@@ -18,6 +18,10 @@ private slots:
     void testDatabaseFKInsertFromChild();
     void testDatabaseFKChangeFromParent();
     void testDatabaseFKChangeFromChild();
+    void testDatabaseFKOnlyChangedChildren();
+    void testPrefetchToOneRelation();
+    void testResolveToManyRelation();
+    void testResolveSharedTarget();
 
 private:
     QpMetaProperty m_parentToChildRelation;
@@ -0,0 +1,155 @@
+#include "tst_optimisticconcurrencytest.h"
+
+#include <QPersistence/legacysqldatasource.h>
+#include "../src/datasourceresult.h"
+
+OptimisticConcurrencyTest::OptimisticConcurrencyTest(QObject *parent) :
+    QObject(parent),
+    m_storage(nullptr)
+{
+}
+
+void OptimisticConcurrencyTest::initTestCase()
+{
+    // The other tests use the default storage without optimistic concurrency,
+    // so that this test gets its own storage and its own connection
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(Qp::database(), "OptimisticConcurrencyTest");
+#ifdef QP_FOR_SQLITE
+    db.setDatabaseName("optimisticconcurrencytestdb.sqlite");
+#endif
+    QVERIFY(db.open());
+
+    m_storage = new QpStorage(this);
+    QpLegacySqlDatasource *ds = new QpLegacySqlDatasource(m_storage);
+    ds->setSqlDatabase(db);
+    m_storage->setDatasource(ds);
+    m_storage->setDatabase(db);
+    m_storage->enableOptimisticConcurrency();
+    m_storage->registerClass<TestNameSpace::ParentObject>();
+    m_storage->registerClass<TestNameSpace::ChildObject>();
+
+#ifdef QP_FOR_SQLITE
+    QVERIFY(m_storage->createCleanSchema());
+#else
+    QVERIFY(m_storage->adjustDatabaseSchema());
+#endif
+}
+
+void OptimisticConcurrencyTest::cleanupTestCase()
+{
+#ifdef QP_FOR_MYSQL
+    // MySQL shares the tables with the other tests
+    QpSqlQuery query(m_storage->database());
+    QVERIFY(query.exec("ALTER TABLE parentobject DROP COLUMN _Qp_version"));
+    QVERIFY(query.exec("ALTER TABLE childobject DROP COLUMN _Qp_version"));
+#endif
+
+    delete m_storage;
+    m_storage = nullptr;
+}
+
+int OptimisticConcurrencyTest::counterInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent)
+{
+    QpSqlQuery query(m_storage->database());
+    query.prepare(QString("SELECT counter FROM parentobject WHERE _qp_id = %1")
+                  .arg(m_storage->primaryKey(parent)));
+    if (!query.exec() || !query.first())
+        return -1;
+    return query.value(0).toInt();
+}
+
+bool OptimisticConcurrencyTest::incrementVersionInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent, const QString &set)
+{
+    // Simulates another client, which changes the object
+    QpSqlQuery query(m_storage->database());
+    query.prepare(QString("UPDATE parentobject SET %1_Qp_version = _Qp_version + 1 WHERE _qp_id = %2")
+                  .arg(set.isEmpty() ? QString() : set + ", ")
+                  .arg(m_storage->primaryKey(parent)));
+    return query.exec();
+}
+
+void OptimisticConcurrencyTest::testConflict()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = m_storage->create<TestNameSpace::ParentObject>();
+    parent->setCounter(1);
+    QCOMPARE(m_storage->update(parent), Qp::UpdateSuccess);
+
+    QVERIFY(incrementVersionInDatabase(parent, "counter = 42"));
+
+    // The conflicting update is rebased onto the remote changes and retried
+    parent->setAString("local");
+    QCOMPARE(m_storage->update(parent), Qp::UpdateSuccess);
+    QCOMPARE(parent->counter(), 42);
+    QCOMPARE(parent->aString(), QString("local"));
+    QCOMPARE(counterInDatabase(parent), 42);
+
+    QpSqlQuery query(m_storage->database());
+    query.prepare(QString("SELECT aString FROM parentobject WHERE _qp_id = %1")
+                  .arg(m_storage->primaryKey(parent)));
+    QVERIFY(query.exec());
+    QVERIFY(query.first());
+    QCOMPARE(query.value(0).toString(), QString("local"));
+}
+
+void OptimisticConcurrencyTest::testRepeatedConflicts()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = m_storage->create<TestNameSpace::ParentObject>();
+    QpDataAccessObjectBase *dao = m_storage->dataAccessObject(parent);
+
+    // Somebody else changes the object again after each of our rebases
+    QMetaObject::Connection connection = connect(dao, &QpDataAccessObjectBase::objectSynchronized, [&] {
+        incrementVersionInDatabase(parent);
+    });
+
+    QVERIFY(incrementVersionInDatabase(parent));
+    parent->setCounter(1);
+    QCOMPARE(m_storage->update(parent), Qp::UpdateError);
+    QCOMPARE(m_storage->lastError().type(), QpError::UpdateConflictError);
+
+    disconnect(connection);
+    m_storage->setLastError(QpError());
+
+    QCOMPARE(m_storage->update(parent), Qp::UpdateSuccess);
+    QCOMPARE(counterInDatabase(parent), 1);
+}
+
+void OptimisticConcurrencyTest::testBulkConflictRollsBack()
+{
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = m_storage->createObjects<TestNameSpace::ParentObject>(3);
+    QSharedPointer<TestNameSpace::ParentObject> written = parents.at(0);
+    QSharedPointer<TestNameSpace::ParentObject> conflicting = parents.at(1);
+    QSharedPointer<TestNameSpace::ParentObject> removed = parents.at(2);
+    int removedKey = m_storage->primaryKey(removed);
+    QpDataAccessObjectBase *dao = m_storage->dataAccessObject(written);
+
+    QSignalSpy updated(dao, SIGNAL(objectUpdated(QSharedPointer<QObject>)));
+    QSignalSpy removedSpy(dao, SIGNAL(objectRemoved(QSharedPointer<QObject>)));
+
+    // The first object is written, before the conflict of the second one rolls back the transaction
+    m_storage->startBulkDatabaseQueries();
+    written->setCounter(1);
+    QCOMPARE(m_storage->update(written), Qp::UpdateSuccess);
+    conflicting->setCounter(2);
+    QCOMPARE(m_storage->update(conflicting), Qp::UpdateSuccess);
+    QVERIFY(m_storage->remove(removed));
+    QVERIFY(incrementVersionInDatabase(conflicting, "counter = 42"));
+
+    QVERIFY(!m_storage->commitBulkDatabaseQueries());
+    m_storage->setLastError(QpError());
+
+    QCOMPARE(counterInDatabase(written), 0);
+    QCOMPARE(updated.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // Nothing has been written back, so that the local changes are still pending
+    QCOMPARE(written->counter(), 1);
+    QVERIFY(QpDataTransferObject::changesInObject(written.data()).hasChanges());
+
+    // The removed object has neither been evicted from the cache nor been removed
+    QVERIFY(dao->cache().contains(removedKey));
+    QCOMPARE(m_storage->read<TestNameSpace::ParentObject>(removedKey), removed);
+
+    QCOMPARE(m_storage->update(written), Qp::UpdateSuccess);
+    QCOMPARE(counterInDatabase(written), 1);
+    QCOMPARE(updated.count(), 1);
+}
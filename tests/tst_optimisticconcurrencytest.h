@@ -0,0 +1,27 @@
+#ifndef TST_OPTIMISTICCONCURRENCYTEST_H
+#define TST_OPTIMISTICCONCURRENCYTEST_H
+
+#include "tests_common.h"
+
+class OptimisticConcurrencyTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OptimisticConcurrencyTest(QObject *parent = 0);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testConflict();
+    void testRepeatedConflicts();
+    void testBulkConflictRollsBack();
+
+private:
+    QpStorage *m_storage;
+
+    int counterInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent);
+    bool incrementVersionInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent, const QString &set = QString());
+};
+
+#endif // TST_OPTIMISTICCONCURRENCYTEST_H
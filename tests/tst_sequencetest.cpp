@@ -0,0 +1,46 @@
+#include "tst_sequencetest.h"
+
+SequenceTest::SequenceTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void SequenceTest::testSequence()
+{
+    QpStorage *storage = Qp::defaultStorage();
+    storage->setSequenceBlockSize(5);
+
+    QpSqlQuery query(Qp::database());
+    QVERIFY(query.exec("SELECT MAX(counter) FROM parentobject"));
+    QVERIFY(query.first());
+    int maximum = query.value(0).toInt();
+
+    // A new sequence continues after the largest value in the column
+    int first = Qp::nextValue<TestNameSpace::ParentObject>("counter");
+    QCOMPARE(first, maximum + 1);
+    QCOMPARE(Qp::nextValue<TestNameSpace::ParentObject>("counter"), first + 1);
+
+    // The whole block has been reserved with the first value
+    QVERIFY(query.exec("SELECT value FROM _Qp_sequences WHERE name = 'parentobject.counter'"));
+    QVERIFY(query.first());
+    QCOMPARE(query.value(0).toInt(), first + 4);
+
+    storage->setIncrementMode(QpStorage::SequenceIncrement);
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QVERIFY(Qp::incrementNumericColumn(parent, "counter"));
+    QCOMPARE(parent->counter(), first + 2);
+    QCOMPARE(counterInDatabase(parent), first + 2);
+
+    // Inside a session the update would only be queued, so the increment is rejected
+    {
+        QpSession session;
+        QVERIFY(!Qp::incrementNumericColumn(parent, "counter"));
+        QCOMPARE(storage->lastError().type(), QpError::TransactionError);
+    }
+    storage->setLastError(QpError());
+    QCOMPARE(parent->counter(), first + 2);
+    QCOMPARE(counterInDatabase(parent), first + 2);
+
+    storage->setIncrementMode(QpStorage::TableMaximumIncrement);
+    storage->setSequenceBlockSize(20);
+}
@@ -0,0 +1,16 @@
+#ifndef TST_SEQUENCETEST_H
+#define TST_SEQUENCETEST_H
+
+#include "tests_common.h"
+
+class SequenceTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SequenceTest(QObject *parent = 0);
+
+private slots:
+    void testSequence();
+};
+
+#endif // TST_SEQUENCETEST_H
@@ -0,0 +1,82 @@
+#include "tst_sessiontest.h"
+
+SessionTest::SessionTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void SessionTest::testSession()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QSignalSpy updated(Qp::dataAccessObject<TestNameSpace::ParentObject>(), SIGNAL(objectUpdated(QSharedPointer<QObject>)));
+
+    {
+        QpSession session;
+        parent->setCounter(5);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        parent->setCounter(6);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        QCOMPARE(counterInDatabase(parent), 0);
+        QCOMPARE(updated.count(), 0);
+
+        QVERIFY(session.commit());
+        QVERIFY(!session.isOpen());
+    }
+    QCOMPARE(counterInDatabase(parent), 6);
+    QCOMPARE(updated.count(), 1);
+
+    // A session, which is not committed, writes nothing
+    {
+        QpSession session;
+        parent->setCounter(7);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    }
+    QCOMPARE(counterInDatabase(parent), 6);
+    QCOMPARE(updated.count(), 1);
+}
+
+void SessionTest::testMergeWritesInOrder()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QList<QSharedPointer<TestNameSpace::ChildObject> > children = Qp::createObjects<TestNameSpace::ChildObject>(2);
+    QpMetaProperty relation = QpMetaObject::forClassName(TestNameSpace::ParentObject::staticMetaObject.className()).metaProperty("hasMany");
+
+    QStringList statements = executedStatements([&] {
+        QpSession session;
+        parent->setCounter(1);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        parent->addHasMany(children.at(0));
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        parent->addHasMany(children.at(1));
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        parent->setCounter(2);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        QVERIFY(session.commit());
+    });
+
+    // The four updates of the parent are written as one UPDATE, followed by one UPDATE,
+    // which relates both children
+    QStringList writes;
+    foreach (const QString &statement, statements) {
+        if (!statement.startsWith("UPDATE", Qt::CaseInsensitive)
+                || statement.section(' ', 2, 2).compare("SET", Qt::CaseInsensitive) != 0) {
+            continue;
+        }
+
+        QString table = statement.section(' ', 1, 1);
+        if (table.contains("parentobject", Qt::CaseInsensitive))
+            writes.append("parent");
+        else if (table.contains(relation.tableName(), Qt::CaseInsensitive))
+            writes.append("children");
+    }
+    QCOMPARE(writes, QStringList() << "parent" << "children");
+
+    QCOMPARE(counterInDatabase(parent), 2);
+    QpSqlQuery query(Qp::database());
+    QVERIFY(query.exec(QString("SELECT COUNT(*) FROM %1 WHERE %2 = %3")
+                       .arg(relation.tableName())
+                       .arg(relation.columnName())
+                       .arg(Qp::primaryKey(parent))));
+    QVERIFY(query.first());
+    QCOMPARE(query.value(0).toInt(), 2);
+}
@@ -0,0 +1,17 @@
+#ifndef TST_SESSIONTEST_H
+#define TST_SESSIONTEST_H
+
+#include "tests_common.h"
+
+class SessionTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SessionTest(QObject *parent = 0);
+
+private slots:
+    void testSession();
+    void testMergeWritesInOrder();
+};
+
+#endif // TST_SESSIONTEST_H
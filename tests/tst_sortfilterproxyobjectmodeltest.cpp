@@ -0,0 +1,91 @@
+#include "tst_sortfilterproxyobjectmodeltest.h"
+
+SortFilterProxyObjectModelTest::SortFilterProxyObjectModelTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+class CounterSortFilterModel : public QpSortFilterProxyObjectModel<TestNameSpace::ParentObject>
+{
+public:
+    QString tag;
+
+protected:
+    QString sortRoleColumn(int) const Q_DECL_OVERRIDE
+    {
+        return QLatin1String("counter");
+    }
+
+    QpCondition filterCondition() const Q_DECL_OVERRIDE
+    {
+        return QpCondition(QLatin1String("aString"), QpCondition::EqualTo, tag);
+    }
+};
+
+void SortFilterProxyObjectModelTest::testSortAndFilterInDatabase()
+{
+    QString tag = QString("sortAndFilter%1").arg(QDateTime::currentMSecsSinceEpoch());
+    for (int i = 0; i < 10; ++i) {
+        QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+        parent->setAString(tag);
+        parent->setCounter(i);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    }
+
+    QpObjectListModel<TestNameSpace::ParentObject> source;
+    source.setFetchCount(4);
+    CounterSortFilterModel model;
+    model.tag = tag;
+    model.setSourceModel(&source);
+    model.setSortingAndFilteringInDatabase(true);
+    model.sort(0, Qt::DescendingOrder);
+
+    // The first page already holds the largest counters of the filtered objects
+    source.fetchMore();
+    QCOMPARE(source.rowCount(), 4);
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(model.objectByIndex(model.index(0, 0))->counter(), 9);
+    QCOMPARE(model.objectByIndex(model.index(3, 0))->counter(), 6);
+
+    while (source.canFetchMore())
+        source.fetchMore();
+    QCOMPARE(source.rowCount(), 10);
+    QCOMPARE(model.objectByIndex(model.index(9, 0))->counter(), 0);
+}
+
+void SortFilterProxyObjectModelTest::testSortAndFilterInDatabaseKeepsSourceCondition()
+{
+    QString tag = QString("sourceCondition%1").arg(QDateTime::currentMSecsSinceEpoch());
+    for (int i = 0; i < 10; ++i) {
+        QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+        parent->setAString(tag);
+        parent->setCounter(i);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    }
+
+    QpCondition sourceCondition(QLatin1String("counter"), QpCondition::LessThan, 5);
+    QpObjectListModel<TestNameSpace::ParentObject> source;
+    source.setCondition(sourceCondition);
+    CounterSortFilterModel model;
+    model.tag = tag;
+    model.setSourceModel(&source);
+    model.setSortingAndFilteringInDatabase(true);
+
+    // Both the condition of the source and the filter condition apply
+    while (source.canFetchMore())
+        source.fetchMore();
+    QCOMPARE(source.rowCount(), 5);
+    foreach (QSharedPointer<TestNameSpace::ParentObject> parent, model.objects()) {
+        QCOMPARE(parent->aString(), tag);
+        QVERIFY(parent->counter() < 5);
+    }
+
+    model.tag = tag + QLatin1String("-none");
+    model.invalidateFilterCondition();
+    while (source.canFetchMore())
+        source.fetchMore();
+    QCOMPARE(source.rowCount(), 0);
+
+    model.setSortingAndFilteringInDatabase(false);
+    QCOMPARE(source.condition().toSqlClause(), sourceCondition.toSqlClause());
+}
@@ -0,0 +1,17 @@
+#ifndef TST_SORTFILTERPROXYOBJECTMODELTEST_H
+#define TST_SORTFILTERPROXYOBJECTMODELTEST_H
+
+#include "tests_common.h"
+
+class SortFilterProxyObjectModelTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SortFilterProxyObjectModelTest(QObject *parent = 0);
+
+private slots:
+    void testSortAndFilterInDatabase();
+    void testSortAndFilterInDatabaseKeepsSourceCondition();
+};
+
+#endif // TST_SORTFILTERPROXYOBJECTMODELTEST_H
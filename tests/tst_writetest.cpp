@@ -0,0 +1,209 @@
+#include "tst_writetest.h"
+
+WriteTest::WriteTest(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void WriteTest::testCreateObjects()
+{
+    int countBefore = Qp::count<TestNameSpace::ParentObject>();
+
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::createObjects<TestNameSpace::ParentObject>(10);
+    QCOMPARE(parents.size(), 10);
+    QCOMPARE(Qp::count<TestNameSpace::ParentObject>(), countBefore + 10);
+
+    int previousKey = 0;
+    foreach (QSharedPointer<TestNameSpace::ParentObject> parent, parents) {
+        int key = Qp::primaryKey(parent);
+        QVERIFY(key > previousKey);
+        QCOMPARE(Qp::read<TestNameSpace::ParentObject>(key), parent);
+        previousKey = key;
+    }
+}
+
+void WriteTest::testCreateObjectsInChunks()
+{
+    QpDataAccessObjectBase *dao = Qp::defaultStorage()->dataAccessObject<TestNameSpace::ParentObject>();
+
+    // More objects than fit into one statement with SQLite's placeholder limit
+    QList<QObject *> objects;
+    for (int i = 0; i < 500; ++i) {
+        TestNameSpace::ParentObject *parent = new TestNameSpace::ParentObject;
+        parent->setCounter(i);
+        objects.append(parent);
+    }
+
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::castList<TestNameSpace::ParentObject>(dao->insertObjects(objects));
+    QCOMPARE(parents.size(), 500);
+
+    for (int i = 0; i < parents.size(); ++i) {
+        QCOMPARE(parents.at(i)->counter(), i);
+
+        QpSqlQuery query(Qp::database());
+        query.prepare(QString("SELECT counter FROM parentobject WHERE _qp_id = %1")
+                      .arg(Qp::primaryKey(parents.at(i))));
+        QVERIFY(query.exec());
+        QVERIFY(query.first());
+        QCOMPARE(query.value(0).toInt(), i);
+    }
+}
+
+static bool setCounterInDatabase(QSharedPointer<TestNameSpace::ParentObject> parent, int counter)
+{
+    QpSqlQuery query(Qp::database());
+    query.prepare(QString("UPDATE parentobject SET counter = %1 WHERE _qp_id = %2")
+                  .arg(counter)
+                  .arg(Qp::primaryKey(parent)));
+    return query.exec();
+}
+
+// The UPDATE statements on the parentobject table, which function executes
+static QStringList executedUpdates(std::function<void()> function)
+{
+    QStringList updates;
+    foreach (const QString &simplified, executedStatements(function)) {
+        if (simplified.startsWith("UPDATE", Qt::CaseInsensitive)
+                && simplified.section(' ', 1, 1).contains("parentobject", Qt::CaseInsensitive)) {
+            updates.append(simplified);
+        }
+    }
+    return updates;
+}
+
+void WriteTest::testUpdateWithoutChanges()
+{
+    QpDataAccessObjectBase *dao = Qp::defaultStorage()->dataAccessObject<TestNameSpace::ParentObject>();
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    parent->setCounter(1);
+    QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    QCOMPARE(counterInDatabase(parent), 1);
+    int revision = dao->revisionInDatabase(parent);
+
+    // An unchanged object must not write anything, so it does not overwrite the database
+    QStringList updates = executedUpdates([&] {
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    });
+    QVERIFY2(updates.isEmpty(), qPrintable(updates.join('\n')));
+    QCOMPARE(dao->revisionInDatabase(parent), revision);
+}
+
+void WriteTest::testUpdateOnlyChangedColumns()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    parent->setCounter(1);
+    QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+
+    // The unchanged counter column must not be written back
+    QVERIFY(setCounterInDatabase(parent, 42));
+    parent->setAString("changed");
+    QStringList updates = executedUpdates([&] {
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    });
+    QCOMPARE(updates.size(), 1);
+    QString setClause = updates.first().section(" WHERE ", 0, 0, QString::SectionCaseInsensitiveSeps);
+    QVERIFY2(setClause.contains("astring", Qt::CaseInsensitive), qPrintable(setClause));
+    QVERIFY2(!setClause.contains("counter", Qt::CaseInsensitive), qPrintable(setClause));
+    QCOMPARE(counterInDatabase(parent), 42);
+
+    QSharedPointer<TestNameSpace::ParentObject> read = Qp::read<TestNameSpace::ParentObject>(Qp::primaryKey(parent));
+    QCOMPARE(read->aString(), QString("changed"));
+}
+
+void WriteTest::testWriteBack()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+    QVERIFY(Qp::primaryKey(parent) > 0);
+    QVERIFY(!Qp::isDeleted(parent));
+
+    parent->setCounter(7);
+    QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    QCOMPARE(counterInDatabase(parent), 7);
+
+    // The written state is the base for the next update, even though it has not been re-read
+    QVERIFY(setCounterInDatabase(parent, 42));
+    QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    QCOMPARE(counterInDatabase(parent), 42);
+
+    QVERIFY(Qp::markAsDeleted(parent));
+    QVERIFY(Qp::isDeleted(parent));
+    QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+}
+
+void WriteTest::testStatementCache()
+{
+    QSharedPointer<TestNameSpace::ParentObject> parent = Qp::create<TestNameSpace::ParentObject>();
+
+    // The same UPDATE is prepared once and then reused with new bind values
+    for (int i = 0; i < 5; ++i) {
+        parent->setCounter(100 + i);
+        QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+        QCOMPARE(counterInDatabase(parent), 100 + i);
+    }
+
+    // Nested queries with the same SQL must not share a statement
+    QpSqlQuery outer(Qp::database());
+    outer.setTable(QLatin1String("parentobject"));
+    outer.addField(QLatin1String("counter"));
+    outer.setWhereCondition(QpCondition(QLatin1String("_qp_id"), QpCondition::EqualTo, Qp::primaryKey(parent)));
+    outer.prepareSelect();
+    QVERIFY(outer.exec());
+
+    QpSqlQuery inner(Qp::database());
+    inner.setTable(QLatin1String("parentobject"));
+    inner.addField(QLatin1String("counter"));
+    inner.setWhereCondition(QpCondition(QLatin1String("_qp_id"), QpCondition::EqualTo, -1));
+    inner.prepareSelect();
+    QVERIFY(inner.exec());
+    QVERIFY(!inner.first());
+
+    QVERIFY(outer.first());
+    QCOMPARE(outer.value(0).toInt(), 104);
+
+    QpSqlQuery::clearStatementCache(Qp::database());
+    parent->setCounter(200);
+    QCOMPARE(Qp::update(parent), Qp::UpdateSuccess);
+    QCOMPARE(counterInDatabase(parent), 200);
+
+    // A connection, which is removed and added again, must not get the statements of its predecessor
+    for (int i = 0; i < 2; ++i) {
+        {
+            QSqlDatabase db = QSqlDatabase::cloneDatabase(Qp::database(), "StatementCacheTest");
+            QVERIFY(db.open());
+            {
+                QpSqlQuery query(db);
+                QVERIFY(query.prepare("SELECT COUNT(*) FROM parentobject"));
+                QVERIFY(query.exec());
+                QVERIFY(query.first());
+            }
+            QpSqlQuery::removeStatementCache(db);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase("StatementCacheTest");
+    }
+}
+
+void WriteTest::testReadManyPrimaryKeys()
+{
+    QpDataAccessObjectBase *dao = Qp::defaultStorage()->dataAccessObject<TestNameSpace::ParentObject>();
+
+    QList<QObject *> objects;
+    for (int i = 0; i < 1500; ++i) {
+        objects.append(new TestNameSpace::ParentObject);
+    }
+    QList<QSharedPointer<TestNameSpace::ParentObject> > parents = Qp::castList<TestNameSpace::ParentObject>(dao->insertObjects(objects));
+    QCOMPARE(parents.size(), 1500);
+
+    QList<int> keys;
+    foreach (QSharedPointer<TestNameSpace::ParentObject> parent, parents) {
+        keys.append(Qp::primaryKey(parent));
+    }
+
+    QpCondition condition = QpCondition::primaryKeys(keys);
+    QCOMPARE(condition.bindValues().size(), 1500);
+    QCOMPARE(condition.splitInLists(999).size(), 2);
+
+    // More keys than SQLite accepts placeholders in one statement
+    QList<QSharedPointer<TestNameSpace::ParentObject> > read = Qp::readAll<TestNameSpace::ParentObject>(condition);
+    QCOMPARE(read.size(), 1500);
+}
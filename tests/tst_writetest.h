@@ -0,0 +1,22 @@
+#ifndef TST_WRITETEST_H
+#define TST_WRITETEST_H
+
+#include "tests_common.h"
+
+class WriteTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WriteTest(QObject *parent = 0);
+
+private slots:
+    void testCreateObjects();
+    void testCreateObjectsInChunks();
+    void testUpdateWithoutChanges();
+    void testUpdateOnlyChangedColumns();
+    void testWriteBack();
+    void testStatementCache();
+    void testReadManyPrimaryKeys();
+};
+
+#endif // TST_WRITETEST_H